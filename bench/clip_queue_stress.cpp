@@ -0,0 +1,144 @@
+//
+// Created by jibbo on 3/23/21.
+//
+
+#include <SpscQueue.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+/*!
+ * \brief Command sent through the queue.
+ *
+ * Mirrors the shape of ClipCommand, check repeats the other fields so a partially copied slot is detected.
+ */
+struct StressCommand {
+    unsigned long long seq = 0;     /**<  sequence number of the accepted push */
+    int clip = 0;                   /**<  target clip index */
+    int type = 0;                   /**<  play, stop or loop */
+    unsigned long long check = 0;   /**<  hash of the other fields */
+};
+
+/*!
+ * Hash the command fields.
+ */
+static unsigned long long commandCheck(unsigned long long seq, int clip, int type) {
+    unsigned long long h = seq * 0x9E3779B97F4A7C15ULL;
+    h ^= (unsigned long long) clip * 0xC2B2AE3D27D4EB4FULL;
+    h ^= (unsigned long long) type << 61;
+    return h;
+}
+
+/*!
+ * Stress test entry point
+ *
+ * A producer thread fires play/stop/loop commands at a fixed rate while a consumer thread
+ * drains them in bursts like the audio callback does once per buffer.
+ * Fails if a command is lost after being accepted, arrives out of order or arrives torn.
+ *
+ * usage: clip_queue_stress [seconds] [triggers per second] [callback period in microseconds]
+ */
+int main(int argc, char* args[]) {
+    double seconds = argc > 1 ? atof(args[1]) : 2.0;
+    double rate = argc > 2 ? atof(args[2]) : 50000.0;
+    int period = argc > 3 ? atoi(args[3]) : 1000;
+
+    static SpscQueue<StressCommand, 256> queue;
+    std::atomic<bool> done(false);
+
+    unsigned long long accepted = 0;
+    unsigned long long dropped = 0;
+    double maxPush = 0;
+
+    unsigned long long received = 0;
+    unsigned long long errors = 0;
+    unsigned long long drains = 0;
+    size_t maxDepth = 0;
+
+    std::thread consumer([&]() {
+        unsigned long long expected = 0;
+        StressCommand c;
+        // keep draining after the producer stops so every accepted command is checked
+        while (true) {
+            bool finished = done.load(std::memory_order_acquire);
+
+            size_t depth = queue.size();
+            if (depth > maxDepth) {
+                maxDepth = depth;
+            }
+
+            while (queue.pop(c)) {
+                if (c.seq != expected || c.check != commandCheck(c.seq, c.clip, c.type)) {
+                    if (errors < 10) {
+                        printf("bad command: seq %llu expected %llu\n", c.seq, expected);
+                    }
+                    ++errors;
+                }
+                expected = c.seq + 1;
+                ++received;
+            }
+            ++drains;
+
+            if (finished) {
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(period));
+        }
+    });
+
+    auto start = std::chrono::steady_clock::now();
+    auto end = start + std::chrono::duration<double>(seconds);
+    auto interval = std::chrono::duration<double>(1.0 / rate);
+    auto next = start;
+    unsigned long long fired = 0;
+
+    while (std::chrono::steady_clock::now() < end) {
+        while (std::chrono::steady_clock::now() < next) {
+            std::this_thread::yield();
+        }
+        next += std::chrono::duration_cast<std::chrono::steady_clock::duration>(interval);
+
+        StressCommand c;
+        c.seq = accepted;
+        c.clip = (int) (fired % 7);
+        c.type = (int) (fired % 3);
+        c.check = commandCheck(c.seq, c.clip, c.type);
+
+        auto t0 = std::chrono::steady_clock::now();
+        bool ok = queue.push(c);
+        double pushTime = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+        if (pushTime > maxPush) {
+            maxPush = pushTime;
+        }
+
+        if (ok) {
+            ++accepted;
+        } else {
+            ++dropped;
+        }
+        ++fired;
+    }
+
+    done.store(true, std::memory_order_release);
+    consumer.join();
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printf("%-24s %llu (%.0f/s)\n", "triggers", fired, fired / elapsed);
+    printf("%-24s %llu\n", "accepted", accepted);
+    printf("%-24s %llu\n", "dropped (queue full)", dropped);
+    printf("%-24s %llu\n", "received", received);
+    printf("%-24s %llu\n", "callback drains", drains);
+    printf("%-24s %zu / %zu\n", "max queue depth", maxDepth, queue.capacity());
+    printf("%-24s %.2f us\n", "max push time", maxPush);
+
+    if (errors > 0 || received != accepted) {
+        printf("FAILED: %llu bad commands, %llu lost\n", errors, accepted - received);
+        return 1;
+    }
+
+    printf("OK\n");
+    return 0;
+}
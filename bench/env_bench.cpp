@@ -0,0 +1,112 @@
+//
+// Created by jibbo on 4/2/21.
+//
+
+#include <BreakjoeEnv.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+/*!
+ * Benchmark entry point
+ *
+ * Steps the breakjoe_env library through its C interface the way a trainer would, with a ball tracking action
+ * computed from the observations of the previous step, and reports environment steps per second.
+ * Every environment aims at a different spot of the paddle so the balls don't all bounce straight up.
+ * --pixels WxH also renders a grayscale pixel observation of every environment after every step and times it.
+ *
+ * usage: bench_env [--envs N] [--threads N] [--steps N] [--pixels WxH] level ...
+ */
+int main(int argc, char* args[]) {
+    int envs = 4096;
+    int threads = 0;
+    int steps = 1000;
+    int pixelWidth = 0;
+    int pixelHeight = 0;
+    std::vector<const char *> levels;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = args[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--envs" && hasValue) {
+            envs = atoi(args[++i]);
+        } else if (arg == "--threads" && hasValue) {
+            threads = atoi(args[++i]);
+        } else if (arg == "--steps" && hasValue) {
+            steps = atoi(args[++i]);
+        } else if (arg == "--pixels" && hasValue) {
+            if (sscanf(args[++i], "%dx%d", &pixelWidth, &pixelHeight) != 2) {
+                pixelWidth = 0;
+                pixelHeight = 0;
+            }
+        } else {
+            levels.push_back(args[i]);
+        }
+    }
+
+    if (levels.empty()) {
+        printf("usage: %s [--envs N] [--threads N] [--steps N] [--pixels WxH] level ...\n", args[0]);
+        return 1;
+    }
+
+    BreakjoeEnv *env = breakjoe_env_create(levels.data(), (int) levels.size(), envs, threads, 60 * 60 * 10);
+    if (env == nullptr) {
+        return 1;
+    }
+
+    int size = breakjoe_env_observation_size(env);
+    std::vector<float> observations((size_t) envs * size);
+    std::vector<uint8_t> actions(envs);
+    std::vector<float> rewards(envs);
+    std::vector<uint8_t> dones(envs);
+    std::vector<uint8_t> pixels((size_t) envs * pixelWidth * pixelHeight);
+
+    breakjoe_env_reset(env, observations.data());
+
+    double reward = 0;
+    int episodes = 0;
+    double seconds = 0;
+    double renderSeconds = 0;
+    for (int s = 0; s < steps; ++s) {
+        // deciding on the actions is the trainer's time, only the step is timed
+        for (int i = 0; i < envs; ++i) {
+            const float *obs = &observations[(size_t) i * size];
+            float aim = (float) ((i * 37) % 81 - 40);
+            float offset = obs[BREAKJOE_OBS_BALL_X] - aim - obs[BREAKJOE_OBS_PADDLE_X];
+            uint8_t action = obs[BREAKJOE_OBS_CAPTURED] != 0 ? BREAKJOE_ACTION_SHOOT : 0;
+            action |= offset < -5 ? BREAKJOE_ACTION_LEFT : 0;
+            action |= offset > 5 ? BREAKJOE_ACTION_RIGHT : 0;
+            actions[i] = action;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        breakjoe_env_step(env, actions.data(), rewards.data(), dones.data(), observations.data());
+        seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        if (!pixels.empty()) {
+            start = std::chrono::steady_clock::now();
+            breakjoe_env_render(env, pixelWidth, pixelHeight, 1, pixels.data());
+            renderSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        for (int i = 0; i < envs; ++i) {
+            reward += rewards[i];
+            episodes += dones[i] != 0;
+        }
+    }
+
+    double total = (double) envs * steps;
+    printf("%d envs, %d floats per observation, %d steps\n", envs, size, steps);
+    printf("  %.0f env steps in %.3f s (%.2fM env steps/s)\n", total, seconds, total / seconds / 1e6);
+    printf("  %d episodes ended, %.3f reward per step\n", episodes, reward / total);
+    if (!pixels.empty()) {
+        printf("  %dx%d gray frames: %.3f s (%.2fM frames/s)\n", pixelWidth, pixelHeight, renderSeconds,
+               total / renderSeconds / 1e6);
+    }
+
+    breakjoe_env_destroy(env);
+    return 0;
+}
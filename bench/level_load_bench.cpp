@@ -0,0 +1,97 @@
+//
+// Created by jibbo on 3/26/21.
+//
+
+#include <World.h>
+#include <LevelFile.h>
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+/*!
+ * \brief Build a level string with the given number of bricks.
+ * @param bricks total number of bricks
+ * @param cols bricks per row
+ * @return level data
+ */
+static std::string makeLevel(int bricks, int cols) {
+    std::string level;
+    int placed = 0;
+    while (placed < bricks) {
+        std::string row;
+        for (int i = 0; i < cols; ++i) {
+            row.push_back(placed < bricks ? (char) ('1' + placed % 9) : '0');
+            ++placed;
+        }
+        level += row + "\n";
+    }
+    return level;
+}
+
+/*!
+ * \brief Time clearing the world and loading a level into it.
+ * @return milliseconds per load
+ */
+template<typename F>
+static double timeLoads(World &world, F load) {
+    const int RUNS = 20;
+    double total = 0;
+    for (int i = 0; i < RUNS; ++i) {
+        world.clearLevel();
+        auto start = std::chrono::steady_clock::now();
+        load();
+        total += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+    return total / RUNS;
+}
+
+/*!
+ * Benchmark entry point
+ *
+ * Times loading generated levels from text and from the compiled, memory mapped format.
+ * Every load includes opening the file, so the compiled path pays for mmap too.
+ */
+int main(int argc, char* args[]) {
+    const char *textPath = "bench_level.txt";
+    const char *binaryPath = "bench_level.bjl";
+
+    printf("%10s %14s %14s %14s\n", "bricks", "text (ms)", "bjl (ms)", "bjl+rects (ms)");
+
+    for (int bricks = 100; bricks <= 100000; bricks *= 10) {
+        WorldConfig config;
+        config.brickHeight = 2;
+        config.brickSpacing = 1;
+
+        std::string str = makeLevel(bricks, 200);
+        FILE *f = fopen(textPath, "wb");
+        fwrite(str.data(), 1, str.size(), f);
+        fclose(f);
+
+        LevelText text;
+        text.parse(str);
+
+        World world;
+        world.config = config;
+        world.startUp();
+
+        double textTime = timeLoads(world, [&]() { world.loadLevel(textPath); });
+        int textBricks = world.bricksLeft;
+
+        writeLevelFile(binaryPath, text.layout(), nullptr);
+        double binaryTime = timeLoads(world, [&]() { world.loadLevel(binaryPath); });
+
+        writeLevelFile(binaryPath, text.layout(), &config);
+        double rectTime = timeLoads(world, [&]() { world.loadLevel(binaryPath); });
+
+        if (world.bricksLeft != textBricks) {
+            printf("brick count mismatch: text %d, compiled %d\n", textBricks, world.bricksLeft);
+            return 1;
+        }
+
+        printf("%10d %14.3f %14.3f %14.3f\n", bricks, textTime, binaryTime, rectTime);
+    }
+
+    remove(textPath);
+    remove(binaryPath);
+    return 0;
+}
@@ -0,0 +1,118 @@
+//
+// Created by jibbo on 3/25/21.
+//
+
+#include <AudioMixer.h>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+static const size_t BUFFER_SAMPLES = 4096 * 2;  /**<  one callback buffer of the game, 4096 stereo frames */
+static const size_t CLIP_SAMPLES = 44100 * 2;   /**<  one second of stereo audio */
+static const int CLIPS = 16;                    /**<  distinct clips the voices read from */
+
+/*!
+ * \brief Per voice clipped add, the way SDL_MixAudio mixes S16 audio.
+ */
+static void mixClipped(int16_t *dst, const int16_t *src, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        int32_t s = dst[i] + src[i];
+        if (s > INT16_MAX) {
+            s = INT16_MAX;
+        } else if (s < INT16_MIN) {
+            s = INT16_MIN;
+        }
+        dst[i] = (int16_t) s;
+    }
+}
+
+/*!
+ * \brief Time a mixing function.
+ * @return nanoseconds per buffer
+ */
+template<typename F>
+static double timeBuffers(F fn) {
+    // warm up the caches and clock before timing
+    for (int i = 0; i < 10; ++i) {
+        fn();
+    }
+
+    int iterations = 0;
+    auto start = std::chrono::steady_clock::now();
+    double elapsed = 0;
+    // run for at least 100ms so short configurations still give a stable average
+    while (elapsed < 0.1) {
+        fn();
+        ++iterations;
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    return elapsed * 1e9 / iterations;
+}
+
+/*!
+ * Benchmark entry point
+ *
+ * Mixes 1 to 256 voices into one callback buffer and reports the cost per buffer of
+ * the SDL_MixAudio style clipped add, the scalar 32 bit sum and the SIMD 32 bit sum.
+ */
+int main(int argc, char* args[]) {
+    std::vector<std::vector<int16_t>> clips(CLIPS, std::vector<int16_t>(CLIP_SAMPLES));
+    unsigned int seed = 12345;
+    for (std::vector<int16_t> &clip : clips) {
+        for (int16_t &s : clip) {
+            seed = seed * 1103515245u + 12345u;
+            s = (int16_t) (seed >> 16);
+        }
+    }
+
+    std::vector<int16_t> out(BUFFER_SAMPLES);
+    std::vector<int16_t> reference(BUFFER_SAMPLES);
+    std::vector<int32_t> sum(BUFFER_SAMPLES);
+    AudioMixer mixer;
+    mixer.reserve(BUFFER_SAMPLES);
+
+    printf("kernel: %s, buffer: %zu samples\n", AudioMixer::kernel(), BUFFER_SAMPLES);
+    printf("%8s %16s %16s %16s %10s\n", "voices", "clipped (ns)", "scalar (ns)", "simd (ns)", "speedup");
+
+    for (int voices = 1; voices <= 256; voices *= 2) {
+        // every voice starts at a different place in its clip
+        std::vector<const int16_t *> sources;
+        for (int v = 0; v < voices; ++v) {
+            size_t offset = ((size_t) v * 4099 * 2) % (CLIP_SAMPLES - BUFFER_SAMPLES);
+            sources.push_back(&clips[v % CLIPS][offset]);
+        }
+
+        double clipped = timeBuffers([&]() {
+            memset(out.data(), 0, BUFFER_SAMPLES * sizeof(int16_t));
+            for (const int16_t *src : sources) {
+                mixClipped(out.data(), src, BUFFER_SAMPLES);
+            }
+        });
+
+        double scalar = timeBuffers([&]() {
+            memset(sum.data(), 0, BUFFER_SAMPLES * sizeof(int32_t));
+            for (const int16_t *src : sources) {
+                AudioMixer::accumulateScalar(sum.data(), src, BUFFER_SAMPLES);
+            }
+            AudioMixer::saturateScalar(reference.data(), sum.data(), BUFFER_SAMPLES);
+        });
+
+        double simd = timeBuffers([&]() {
+            mixer.begin(BUFFER_SAMPLES);
+            for (const int16_t *src : sources) {
+                mixer.add(0, src, BUFFER_SAMPLES);
+            }
+            mixer.resolve(out.data());
+        });
+
+        if (memcmp(out.data(), reference.data(), BUFFER_SAMPLES * sizeof(int16_t)) != 0) {
+            printf("mismatch between the scalar and %s mix at %d voices\n", AudioMixer::kernel(), voices);
+            return 1;
+        }
+
+        printf("%8d %16.0f %16.0f %16.0f %9.2fx\n", voices, clipped, scalar, simd, clipped / simd);
+    }
+
+    return 0;
+}
@@ -0,0 +1,111 @@
+//
+// Created by jibbo on 4/5/21.
+//
+
+#include <World.h>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+/*!
+ * \brief Load a level of rows x cols bricks.
+ *
+ * Level files stop at 9 hits, tens of thousands of balls would clear that in a few hundred ticks,
+ * so the bricks get more hits after loading.
+ */
+static void loadField(World &world, int rows, int cols) {
+    std::string level;
+    for (int r = 0; r < rows; ++r) {
+        level += std::string(cols, '9') + "\n";
+    }
+    world.clearLevel();
+    world.loadLevelData(level);
+
+    for (int i = 0; i < world.entities.size(); ++i) {
+        if (world.entities.typeId[i] == 2) {
+            world.entities.hits[i] = 1000;
+        }
+    }
+    world.score = 0;
+}
+
+/*!
+ * \brief Serve a ball split into count balls.
+ * @param world world with a loaded level
+ * @param count balls in play after the serve
+ * @param wide paddle spans the screen so no ball is ever lost
+ */
+static void serve(World &world, int count, bool wide) {
+    world.config.multiBall = count - 1;
+    world.player.width() = wide ? (float) world.config.screenWidth : 100.0f;
+    world.player.pos() = Vector3D((float) world.config.screenWidth / 2.0f, 20, 0);
+    world.player.vel() = Vector3D(0, 0, 0);
+    world.ballCaptured = true;
+    world.playerLives = INT_MAX;
+    world.pauseTimer = 0;
+
+    WorldInput in;
+    in.shoot = true;
+    world.step(in);
+}
+
+/*!
+ * Benchmark entry point
+ *
+ * Times World::step against the number of balls in play, the multi-ball load test, at the tick rate of the
+ * window game and as a share of its 60 Hz frame. First with a paddle spanning the screen so the ball count stays put, then with the normal paddle
+ * letting the balls fall out of play, which also times the ball-lost bookkeeping.
+ *
+ * usage: bench_multiball [ticks]
+ */
+int main(int argc, char* args[]) {
+    int ticks = argc > 1 ? atoi(args[1]) : 600;
+    const int counts[] = {1, 100, 1000, 10000, 25000, 50000};
+
+    // the window game steps at Game::TICK_RATE, several ticks per 60 Hz frame
+    const int gameTickRate = 240;
+    const int frameRate = 60;
+
+    World world;
+    world.config.tickRate = gameTickRate;
+    world.startUp();
+
+    double ticksPerFrame = (double) gameTickRate / (double) frameRate;
+    double frameBudget = 1e9 / (double) frameRate;
+
+    printf("%10s %14s %14s %14s %14s\n", "balls", "ns/tick", "ticks/s", "ms/frame", "frame budget");
+    for (int count : counts) {
+        loadField(world, 8, 20);
+        serve(world, count, true);
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < ticks; ++i) {
+            world.step(WorldInput());
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        double ns = (double) std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / ticks;
+        printf("%10d %14.0f %14.0f %14.2f %13.1f%%\n", world.extraBalls + 1, ns, 1e9 / ns, ns * ticksPerFrame / 1e6,
+               ns * ticksPerFrame / frameBudget * 100.0);
+    }
+
+    // the normal paddle misses most balls, they drain away through the ball-lost path,
+    // as many frames as the timed runs have ticks gives them time to fall out
+    int count = counts[sizeof(counts) / sizeof(counts[0]) - 1];
+    int drainTicks = ticks * (gameTickRate / frameRate);
+    loadField(world, 8, 20);
+    serve(world, count, false);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < drainTicks; ++i) {
+        world.step(WorldInput());
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double ns = (double) std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / drainTicks;
+    printf("%d balls drained to %d in %d ticks, %.0f ns/tick\n", count, world.extraBalls + 1, drainTicks, ns);
+
+    return 0;
+}
@@ -0,0 +1,81 @@
+//
+// Created by jibbo on 3/8/21.
+//
+
+#include <World.h>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <string>
+
+/*!
+ * \brief Build a level string with the given number of bricks.
+ *
+ * Bricks are laid out in rows of cols bricks, every brick takes 9 hits so the field does not clear mid run.
+ * @param bricks total number of bricks
+ * @param cols bricks per row
+ * @return level data
+ */
+static std::string makeLevel(int bricks, int cols) {
+    std::string level;
+    int placed = 0;
+    while (placed < bricks) {
+        std::string row;
+        for (int i = 0; i < cols; ++i) {
+            row.push_back(placed < bricks ? '9' : '0');
+            ++placed;
+        }
+        level += row + "\n";
+    }
+    return level;
+}
+
+/*!
+ * Benchmark entry point
+ *
+ * Times World::step against the brick count of generated levels.
+ * The ball is released inside the brick field and the paddle spans the screen so the ball is never lost.
+ */
+int main(int argc, char* args[]) {
+    const int TICKS = 2000;
+    const int COLS = 200;
+    const int counts[] = {100, 1000, 5000, 10000, 25000, 50000, 100000};
+
+    World world;
+
+    // small bricks so large fields still fit on the screen
+    world.config.brickHeight = 2;
+    world.config.brickSpacing = 1;
+    world.startUp();
+
+    EntityHandle &player = world.player;
+    EntityHandle &ball = world.ball;
+    player.width() = (float) world.config.screenWidth;
+
+    WorldInput input;
+
+    printf("%10s %14s %14s\n", "bricks", "ns/update", "updates/s");
+    for (int count : counts) {
+        world.clearLevel();
+        world.loadLevelData(makeLevel(count, COLS));
+
+        player.pos() = Vector3D((float) world.config.screenWidth / 2.0f, 20, 0);
+        player.vel() = Vector3D(0, 0, 0);
+        ball.pos() = Vector3D((float) world.config.screenWidth / 2.0f, (float) world.config.screenHeight - 200.0f, 0);
+        ball.vel() = Vector3D(7.0f, -5.0f, 0);
+        world.ballCaptured = false;
+        world.playerLives = INT_MAX;
+        world.pauseTimer = 0;
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < TICKS; ++i) {
+            world.step(input);
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        double ns = (double) std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / TICKS;
+        printf("%10d %14.0f %14.0f\n", count, ns, 1e9 / ns);
+    }
+
+    return 0;
+}
@@ -0,0 +1,109 @@
+//
+// Created by jibbo on 3/29/21.
+//
+
+#ifndef MONOREPO_JSTRACESKI_AUDIO_H
+#define MONOREPO_JSTRACESKI_AUDIO_H
+
+#include <LOpenGL.h>
+#include <Clip.h>
+#include <SpscQueue.h>
+#include <VoicePool.h>
+
+/*!
+ * \brief Playback change sent from the game thread to the audio callback.
+ */
+struct ClipCommand {
+    enum Type {
+        PLAY,   /**<  play the clip on a new voice */
+        STOP,   /**<  stop every voice playing the clip */
+        LOOP    /**<  set the looping flag */
+    };
+
+    Type type = PLAY;       /**<  command type */
+    Clip *clip = nullptr;   /**<  target clip */
+    bool loop = false;      /**<  looping flag for LOOP commands */
+};
+
+/*!
+ * \brief SDL audio output mixing the voices of the game.
+ *
+ * Owns the command queue and the voices, the SDL callback reaches them through its userdata pointer.
+ * Clips are not owned, they have to outlive the device (see close).
+ * Only one thread may send commands.
+ */
+class Audio {
+private:
+    SpscQueue<ClipCommand, 256> commands;   /**<  playback changes waiting for the audio callback */
+    VoicePool voices;                       /**<  voices playing the clips, audio thread only while open */
+    bool opened = false;                    /**<  is the device open */
+
+    /*!
+     * Queue a playback change, never blocks, the command is dropped if the queue is full.
+     * @return false if the queue was full, true otherwise
+     */
+    bool send(const ClipCommand &command) {
+        return commands.push(command);
+    }
+
+    /*!
+     * Apply the queued playback changes, audio thread only.
+     */
+    void drainCommands();
+
+    /*!
+     * \brief Callback passed into the SDL Audio library.
+     *
+     * Applies the queued commands, then mixes all active voices together.
+     *
+     * @param userdata the Audio instance
+     * @param stream audio buffer
+     * @param len length of the buffer
+     */
+    static void callback(void *userdata, Uint8 *stream, int len);
+
+public:
+    Audio() = default;
+    Audio(Audio const&) = delete;           /**<  the callback holds a pointer to the instance */
+    void operator=(Audio const&) = delete;  /**<  Don't allow assignment. */
+
+    ~Audio() {
+        close();
+    }
+
+    /*!
+     * \brief Open the audio device and start playing.
+     * @return false if the device can't be opened, true otherwise
+     */
+    bool open();
+
+    /*!
+     * \brief Stop the callback and release every voice.
+     *
+     * Call before freeing the clips the voices point into.
+     */
+    void close();
+
+    /*!
+     * \brief Queue a clip to play on a new voice.
+     *
+     * Repeated triggers overlap instead of restarting the clip. The caller never waits on the audio thread.
+     * @param clip clip to play, ignored if null
+     */
+    void play(Clip *clip);
+
+    /*!
+     * \brief Queue every voice of a clip to stop.
+     * @param clip clip to stop, ignored if null
+     */
+    void stop(Clip *clip);
+
+    /*!
+     * \brief Queue a change of the looping flag of a clip.
+     * @param clip clip to change, ignored if null
+     * @param loop true to loop the clip
+     */
+    void loop(Clip *clip, bool loop);
+};
+
+#endif //MONOREPO_JSTRACESKI_AUDIO_H
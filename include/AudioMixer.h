@@ -0,0 +1,84 @@
+//
+// Created by jibbo on 3/25/21.
+//
+
+#ifndef MONOREPO_JSTRACESKI_AUDIOMIXER_H
+#define MONOREPO_JSTRACESKI_AUDIOMIXER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*!
+ * \brief Sums signed 16 bit voices in a 32 bit buffer and saturates once at the end.
+ *
+ * Adding every voice without clipping and clamping the sum once keeps loud mixes from distorting
+ * differently depending on the voice order, and lets the inner loops run as plain SIMD adds.
+ * The kernels use AVX2 when the build enables it (BREAKJOE_AVX2), SSE2 on any other x86-64 build
+ * and plain C++ elsewhere. Has no SDL dependency.
+ */
+class AudioMixer {
+private:
+    static const size_t ALIGNMENT = 32;    /**<  sum buffer alignment, unaligned AVX2 stores split cache lines */
+
+    std::vector<int32_t> storage;   /**<  sum buffer allocation with room for alignment */
+    int32_t *accum = nullptr;       /**<  running sum of the current buffer, aligned start of storage */
+    size_t capacity = 0;            /**<  samples accum can hold */
+    size_t samples = 0;             /**<  samples in the current buffer */
+
+public:
+    /*!
+     * \brief Allocate the sum buffer ahead of time.
+     * @param count largest expected buffer in samples, all channels
+     */
+    void reserve(size_t count);
+
+    /*!
+     * \brief Start a new buffer of silence.
+     *
+     * Only allocates when the buffer is larger than every buffer before it.
+     * @param count samples in the buffer, all channels
+     */
+    void begin(size_t count);
+
+    /*!
+     * \brief Add a voice to the buffer.
+     * @param offset first sample of the buffer to add to
+     * @param src samples to add
+     * @param count number of samples, offset + count must not exceed the buffer
+     */
+    void add(size_t offset, const int16_t *src, size_t count);
+
+    /*!
+     * \brief Clamp the sum to 16 bit and write it out.
+     * @param out receives the buffer, must hold the sample count given to begin
+     */
+    void resolve(int16_t *out) const;
+
+    /*!
+     * \brief Name of the kernels compiled in, "avx2", "sse2" or "scalar".
+     */
+    static const char *kernel();
+
+    /*!
+     * \brief Add 16 bit samples to a 32 bit sum with the best kernel available.
+     */
+    static void accumulate(int32_t *dst, const int16_t *src, size_t count);
+
+    /*!
+     * \brief Clamp a 32 bit sum to 16 bit with the best kernel available.
+     */
+    static void saturate(int16_t *dst, const int32_t *src, size_t count);
+
+    /*!
+     * \brief Reference version of accumulate without SIMD.
+     */
+    static void accumulateScalar(int32_t *dst, const int16_t *src, size_t count);
+
+    /*!
+     * \brief Reference version of saturate without SIMD.
+     */
+    static void saturateScalar(int16_t *dst, const int32_t *src, size_t count);
+};
+
+#endif //MONOREPO_JSTRACESKI_AUDIOMIXER_H
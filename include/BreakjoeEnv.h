@@ -0,0 +1,126 @@
+//
+// Created by jibbo on 4/2/21.
+//
+
+#ifndef MONOREPO_JSTRACESKI_BREAKJOEENV_H
+#define MONOREPO_JSTRACESKI_BREAKJOEENV_H
+
+/*
+ * C interface of the breakjoe_env shared library, a vectorized reinforcement learning environment.
+ *
+ * One handle holds N independent games, each one a World playing a single level with the rules of the window game.
+ * step applies an action to every game, advances them in parallel on a thread pool and writes rewards,
+ * done flags and observations straight into buffers owned by the caller, so bindings (ctypes, cffi, numpy)
+ * can hand over their arrays without copies.
+ *
+ * Games that end are restarted inside step, the observation written for them is the first one of the new game.
+ * Plain C so it can be loaded from any language, none of the functions are thread safe on the same handle.
+ */
+
+#include <stdint.h>
+
+#if defined(_WIN32)
+#define BREAKJOE_ENV_API __declspec(dllexport)
+#else
+#define BREAKJOE_ENV_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* action bits, the same as the replay input bits */
+#define BREAKJOE_ACTION_LEFT 1      /**<  accelerate the paddle to the left */
+#define BREAKJOE_ACTION_RIGHT 2     /**<  accelerate the paddle to the right */
+#define BREAKJOE_ACTION_SHOOT 4     /**<  release the ball from the paddle */
+
+/* done values, 0 while the game is running */
+#define BREAKJOE_DONE_CLEARED 1     /**<  every brick of the level was broken */
+#define BREAKJOE_DONE_LOST 2        /**<  the last life was lost */
+#define BREAKJOE_DONE_TIMEOUT 3     /**<  the game reached the tick limit, truncated rather than terminated */
+
+/* observation layout, floats in game units, followed by the hits left of every brick cell */
+#define BREAKJOE_OBS_BALL_X 0           /**<  ball center x */
+#define BREAKJOE_OBS_BALL_Y 1           /**<  ball center y */
+#define BREAKJOE_OBS_BALL_VX 2          /**<  ball velocity x, pixels per base tick */
+#define BREAKJOE_OBS_BALL_VY 3          /**<  ball velocity y, pixels per base tick */
+#define BREAKJOE_OBS_PADDLE_X 4         /**<  paddle center x */
+#define BREAKJOE_OBS_PADDLE_VX 5        /**<  paddle velocity x, pixels per base tick */
+#define BREAKJOE_OBS_CAPTURED 6         /**<  1 if the ball sits on the paddle, 0 otherwise */
+#define BREAKJOE_OBS_LIVES 7            /**<  lives left */
+#define BREAKJOE_OBS_BRICKS_LEFT 8      /**<  bricks that still take hits */
+#define BREAKJOE_OBS_CELLS 9            /**<  first brick cell, row major, 0 for empty and broken cells */
+
+typedef struct BreakjoeEnv BreakjoeEnv;
+
+/*!
+ * \brief Create a set of environments.
+ *
+ * Environment i plays level i % levelCount. Levels are text or compiled (.bjl) level files.
+ * @param levelPaths level files
+ * @param levelCount number of level files
+ * @param envs number of environments
+ * @param threads worker threads, 0 for one per hardware thread
+ * @param maxTicks ticks before a game is cut off with BREAKJOE_DONE_TIMEOUT, 0 for no limit
+ * @return handle, NULL if a level can't be read or the arguments are invalid
+ */
+BREAKJOE_ENV_API BreakjoeEnv *breakjoe_env_create(const char *const *levelPaths, int levelCount, int envs,
+                                                  int threads, int maxTicks);
+
+/*!
+ * \brief Stop the threads and free the environments.
+ */
+BREAKJOE_ENV_API void breakjoe_env_destroy(BreakjoeEnv *env);
+
+/*!
+ * \brief Number of environments.
+ */
+BREAKJOE_ENV_API int breakjoe_env_count(const BreakjoeEnv *env);
+
+/*!
+ * \brief Floats per observation, the same for every environment.
+ *
+ * BREAKJOE_OBS_CELLS plus the cell count of the largest level, smaller levels leave the rest at 0.
+ */
+BREAKJOE_ENV_API int breakjoe_env_observation_size(const BreakjoeEnv *env);
+
+/*!
+ * \brief Restart every game at the start of its level.
+ * @param observations count * observation_size floats receiving the observations, NULL to skip them
+ */
+BREAKJOE_ENV_API void breakjoe_env_reset(BreakjoeEnv *env, float *observations);
+
+/*!
+ * \brief Advance every game by one tick.
+ * @param actions count BREAKJOE_ACTION_ bit sets
+ * @param rewards count floats receiving the score gained during the tick
+ * @param dones count bytes receiving a BREAKJOE_DONE_ value, 0 if the game goes on
+ * @param observations count * observation_size floats receiving the observations, NULL to skip them
+ */
+BREAKJOE_ENV_API void breakjoe_env_step(BreakjoeEnv *env, const uint8_t *actions, float *rewards, uint8_t *dones,
+                                        float *observations);
+
+/*!
+ * \brief Write the current observation of every game.
+ * @param observations count * observation_size floats
+ */
+BREAKJOE_ENV_API void breakjoe_env_observation(const BreakjoeEnv *env, float *observations);
+
+/*!
+ * \brief Draw every game into a pixel observation with the software rasterizer.
+ *
+ * Draws the entities the way the window does, scaled down from the screen to width x height, rows top to bottom.
+ * @param width image width in pixels
+ * @param height image height in pixels
+ * @param channels 1 for grayscale, 4 for RGBA
+ * @param pixels count * width * height * channels bytes
+ * @return 0 if the size or channel count is invalid, 1 otherwise
+ */
+BREAKJOE_ENV_API int breakjoe_env_render(const BreakjoeEnv *env, int width, int height, int channels,
+                                         uint8_t *pixels);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //MONOREPO_JSTRACESKI_BREAKJOEENV_H
@@ -0,0 +1,116 @@
+//
+// Created by jibbo on 3/8/21.
+//
+
+#ifndef MONOREPO_JSTRACESKI_BRICKGRID_H
+#define MONOREPO_JSTRACESKI_BRICKGRID_H
+
+#include <vector>
+#include <cmath>
+
+/*!
+ * \brief Uniform grid broadphase over the level bricks.
+ *
+ * Built from the row/column layout produced by ResourceManager::loadLevel. Every row has the same pitch
+ * (brick height + spacing) and every cell inside a row has the same pitch (brick width + spacing), so the cells
+ * touched by a bounding box are found with a couple of divisions instead of testing every brick.
+ */
+struct BrickGrid {
+    /*!
+     * \brief Single row of cells.
+     */
+    struct Row {
+        float pitch = 0;    /**<  horizontal distance between the left edges of two neighbouring cells */
+        int cols = 0;       /**<  number of cells in the row */
+        int offset = 0;     /**<  index of the first cell of the row in the cell list */
+    };
+
+    float top = 0;          /**<  y position of the top edge of the first row */
+    float rowPitch = 0;     /**<  vertical distance between the top edges of two neighbouring rows */
+
+    std::vector<Row> rows;          /**<  row layout, top to bottom */
+    std::vector<int> cells;         /**<  entity index of the brick in each cell, -1 for empty cells */
+
+    /*!
+     * \brief Reset the grid layout.
+     * @param gridTop y position of the top edge of the first row
+     * @param pitch vertical distance between rows
+     */
+    void reset(float gridTop, float pitch) {
+        top = gridTop;
+        rowPitch = pitch;
+        rows.clear();
+        cells.clear();
+    }
+
+    /*!
+     * \brief Append an empty row below the existing rows.
+     * @param pitch horizontal distance between cells in the row
+     * @param cols number of cells in the row
+     * @return row index
+     */
+    int addRow(float pitch, int cols) {
+        Row row;
+        row.pitch = pitch;
+        row.cols = cols;
+        row.offset = (int) cells.size();
+        rows.emplace_back(row);
+        cells.resize(cells.size() + cols, -1);
+        return (int) rows.size() - 1;
+    }
+
+    /*!
+     * \brief Store a brick in a cell.
+     * @param row row index
+     * @param col column index
+     * @param id entity index of the brick
+     */
+    void set(int row, int col, int id) {
+        cells[rows[row].offset + col] = id;
+    }
+
+    /*!
+     * \brief Visit every brick in the cells overlapped by a bounding box.
+     *
+     * Bricks are visited row by row from the top, left to right, which is the order loadLevel creates them in.
+     *
+     * @param minX left edge of the box
+     * @param minY bottom edge of the box
+     * @param maxX right edge of the box
+     * @param maxY top edge of the box
+     * @param fn callback taking an entity index
+     */
+    template<typename F>
+    void query(float minX, float minY, float maxX, float maxY, F fn) const {
+        if (rows.empty() || rowPitch <= 0) {
+            return;
+        }
+
+        // rows are counted downwards from the top of the grid
+        int r0 = (int) floorf((top - maxY) / rowPitch);
+        int r1 = (int) floorf((top - minY) / rowPitch);
+        if (r0 < 0) r0 = 0;
+        if (r1 > (int) rows.size() - 1) r1 = (int) rows.size() - 1;
+
+        for (int r = r0; r <= r1; ++r) {
+            const Row& row = rows[r];
+            if (row.cols == 0 || row.pitch <= 0) {
+                continue;
+            }
+
+            int c0 = (int) floorf(minX / row.pitch);
+            int c1 = (int) floorf(maxX / row.pitch);
+            if (c0 < 0) c0 = 0;
+            if (c1 > row.cols - 1) c1 = row.cols - 1;
+
+            for (int c = c0; c <= c1; ++c) {
+                int id = cells[row.offset + c];
+                if (id >= 0) {
+                    fn(id);
+                }
+            }
+        }
+    }
+};
+
+#endif //MONOREPO_JSTRACESKI_BRICKGRID_H
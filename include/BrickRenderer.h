@@ -0,0 +1,93 @@
+//
+// Created by jibbo on 4/6/21.
+//
+
+#ifndef MONOREPO_JSTRACESKI_BRICKRENDERER_H
+#define MONOREPO_JSTRACESKI_BRICKRENDERER_H
+
+#include <LOpenGL.h>
+#include <vector>
+#include <World.h>
+
+/*!
+ * \brief Per brick data of the instance buffer.
+ */
+struct BrickInstance {
+    float x, y;         /**<  center in pixels */
+    float w, h;         /**<  size in pixels */
+    float hits;         /**<  hits left, picks the color in the shader */
+};
+
+/*!
+ * \brief Draws the brick field with one instanced draw call.
+ *
+ * Bricks never move, so their rectangles and hits are uploaded into an instance buffer once when a level loads
+ * and only the instances of the bricks the world reports as hit are rewritten afterwards. The vertex shader places a unit quad
+ * per instance and looks the color up from the hits, so drawing the field costs the CPU a single draw call
+ * no matter how many bricks there are.
+ */
+class BrickRenderer {
+private:
+    static const int BRICK_COLORS = 10; /**<  colors for 0 to 9 hits, the size of LHitColors in the shader */
+
+    std::vector<BrickInstance> instances;   /**<  copy of the instance buffer */
+    std::vector<int> instanceOf;            /**<  instance of every entity index, -1 for entities that aren't bricks */
+
+    GLuint program = 0;     /**<  instanced brick shader program */
+    GLuint vao = 0;         /**<  vertex array object */
+    GLuint cornerVbo = 0;   /**<  unit quad corners shared by every instance */
+    GLuint instanceVbo = 0; /**<  one BrickInstance per brick */
+    GLint cornerLoc = -1;   /**<  corner attribute location */
+    GLint rectLoc = -1;     /**<  instance rectangle attribute location */
+    GLint hitsLoc = -1;     /**<  instance hits attribute location */
+    GLint projectionLoc = -1;   /**<  location of the pixel to device projection uniform */
+
+public:
+    int uploads = 0;        /**<  instances written to the buffer since the level was loaded */
+
+    /*!
+     * \brief Create the GL buffers.
+     *
+     * The program needs vec2 LCorner, vec4 LRect and float LHits attributes and mat3 LProjection and
+     * vec4 LHitColors[10] uniforms. The colors are set here from brickColor, hits without a color have alpha 0.
+     * @param programId linked shader program
+     * @param width screen width in pixels
+     * @param height screen height in pixels
+     * @return false if the program is missing the attributes, true otherwise
+     */
+    bool init(GLuint programId, int width, int height);
+
+    /*!
+     * \brief Change the size of the screen the brick rectangles refer to, see SpriteBatch::setScreenSize.
+     * @param width screen width in pixels
+     * @param height screen height in pixels
+     */
+    void setScreenSize(int width, int height);
+
+    /*!
+     * \brief Upload every brick of the current level.
+     * @param world world that just loaded a level
+     */
+    void load(const World &world);
+
+    /*!
+     * \brief Bring the instances up to date after a tick.
+     *
+     * Reloads the field when the level changed, otherwise rewrites only the instances of the bricks in
+     * WorldEvents::bricksHit, so the cost follows the contacts of the tick and not the size of the field.
+     * @param world world after the step
+     */
+    void update(const World &world);
+
+    /*!
+     * \brief Draw every brick.
+     */
+    void draw();
+
+    /*!
+     * \brief Delete the GL buffers.
+     */
+    void shutDown();
+};
+
+#endif //MONOREPO_JSTRACESKI_BRICKRENDERER_H
@@ -7,56 +7,22 @@
 #define MONOREPO_JSTRACESKI_CLIP_H
 
 #include <LOpenGL.h>
-#include <vector>
 
 /*!
  * \brief Struct to hold music data
  *
- * Includes looping and tracking of music position.
+ * Holds the shared audio data and looping flag, playback positions live in the voices of an Audio device.
+ * Clips are loaded once by the ResourceManager and can be played by any number of voices.
+ * loop belongs to the audio thread once the device is running, other threads change it with Audio::loop.
  */
 struct Clip {
 public:
     Uint32 clipLen;         /**<  clip length */
-    Uint32 trackPos = 0;    /**<  track position */
 
     Uint8 *data;            /**<  audio data */
     SDL_AudioSpec spec;     /**<  audio specs */
 
     bool loop = false;      /**<  flag to set the clip looping */
-    bool active = false;    /**<  is the clip playing or not */
-    static std::vector<Clip * > sounds; /**< static list of all sounds */
-
-    /*!
-     * \brief Callback passed into the SDL Audio library.
-     *
-     * Loops through all loaded sounds and mixes them together if they are active.
-     *
-     * @param userdata not used
-     * @param stream audio buffer
-     * @param len length of the buffer
-     */
-    static void callback(void *userdata, Uint8 *stream, int len) {
-        memset(stream, 0, len);
-
-        for (Clip* s : sounds) {
-            if (s->active) {
-                if (s->trackPos + len >= s->clipLen) {
-                    Uint32 last = s->clipLen - s->trackPos;
-                    Uint32 extra = len - last;
-                    SDL_MixAudio(stream, &s->data[s->trackPos], last, SDL_MIX_MAXVOLUME);
-                    if (s->loop) {
-                        SDL_MixAudio(&stream[last], &s->data[0], extra, SDL_MIX_MAXVOLUME);
-                        s->trackPos = extra;
-                    } else {
-                        s->active = false;
-                    }
-                } else {
-                    SDL_MixAudio(stream, &s->data[s->trackPos], len, SDL_MIX_MAXVOLUME);
-                    s->trackPos += len;
-                }
-            }
-        }
-    }
 
     /*!
      * Deconstructor
@@ -19,7 +19,7 @@ struct Entity {
     Vector3D vel; /**<  velocity */
 
     int shapeId = 0; /**<  0 rect / 1 circle */
-    int typeId = 0; /**<  0 paddle / 1 brick / 2 ball */
+    int typeId = 0; /**<  0 paddle or ball / 1 extra ball / 2 brick */
     int hits = 1; /**< counter for bricks, number of hits left */
 
     float radius = 0; /**< If the entity is a circle then this defines the radius, otherwise 0 */
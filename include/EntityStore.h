@@ -0,0 +1,286 @@
+//
+// Created by jibbo on 3/10/21.
+//
+
+#ifndef MONOREPO_JSTRACESKI_ENTITYSTORE_H
+#define MONOREPO_JSTRACESKI_ENTITYSTORE_H
+
+#include <memory>
+#include <utility>
+#include <vector>
+#include <Entity.h>
+
+/*!
+ * \brief Allocator that leaves elements grown without a value uninitialized.
+ *
+ * std::vector value initializes the elements resize adds, which is a wasted pass over arrays the caller writes
+ * right after growing them. Elements constructed from a value are copied as usual.
+ */
+template<typename T>
+struct UninitializedAllocator : std::allocator<T> {
+    template<typename U>
+    struct rebind {
+        using other = UninitializedAllocator<U>;
+    };
+
+    UninitializedAllocator() = default;
+
+    template<typename U>
+    UninitializedAllocator(const UninitializedAllocator<U> &) {}
+
+    template<typename U>
+    void construct(U *p) {
+        ::new((void *) p) U;
+    }
+
+    template<typename U, typename... Args>
+    void construct(U *p, Args &&... args) {
+        ::new((void *) p) U(std::forward<Args>(args)...);
+    }
+};
+
+template<typename T>
+using UnfilledArray = std::vector<T, UninitializedAllocator<T>>;   /**<  array resize leaves uninitialized */
+
+/*!
+ * \brief Structure of arrays holding every entity in the world.
+ *
+ * Each entity field lives in its own packed array and entities are referenced by index, so the physics passes
+ * only pull the fields they use through the cache. Entities are created from an Entity prototype.
+ */
+struct EntityStore {
+    UnfilledArray<Vector3D> pos;    /**<  position */
+    UnfilledArray<Vector3D> f_pos;  /**<  future position, not kept for bricks */
+    UnfilledArray<Vector3D> p_pos;  /**<  position at the start of the last tick for interpolation, not kept for bricks */
+    std::vector<Vector3D> vel;      /**<  velocity */
+
+    UnfilledArray<float> width;     /**<  rectangle width, 0 for circles */
+    UnfilledArray<float> height;    /**<  rectangle height, 0 for circles */
+    std::vector<float> radius;      /**<  circle radius, 0 for rectangles */
+    std::vector<float> drag;        /**<  air drag */
+
+    UnfilledArray<int> hits;        /**<  number of hits left for bricks */
+
+    std::vector<unsigned char> shapeId;     /**<  0 rect / 1 circle */
+    std::vector<unsigned char> typeId;      /**<  0 paddle or ball / 1 extra ball / 2 brick */
+    std::vector<unsigned char> reflects;    /**<  does the entity bounce when it collides */
+    std::vector<unsigned char> active;      /**<  active state */
+
+    int revision = 0;   /**<  incremented every time entities are added or removed */
+
+    /*!
+     * \brief Number of stored entities.
+     * @return entity count
+     */
+    int size() const {
+        return (int) pos.size();
+    }
+
+    /*!
+     * \brief Reserve room for n entities in every array.
+     * @param n entity count
+     */
+    void reserve(int n) {
+        pos.reserve(n);
+        f_pos.reserve(n);
+        p_pos.reserve(n);
+        vel.reserve(n);
+        width.reserve(n);
+        height.reserve(n);
+        radius.reserve(n);
+        drag.reserve(n);
+        hits.reserve(n);
+        shapeId.reserve(n);
+        typeId.reserve(n);
+        reflects.reserve(n);
+        active.reserve(n);
+    }
+
+    /*!
+     * \brief Append an entity.
+     * @param e prototype to copy the fields from
+     * @return index of the new entity
+     */
+    int add(const Entity &e) {
+        pos.emplace_back(e.pos);
+        f_pos.emplace_back(e.pos);
+        p_pos.emplace_back(e.pos);
+        vel.emplace_back(e.vel);
+        width.emplace_back(e.width);
+        height.emplace_back(e.height);
+        radius.emplace_back(e.radius);
+        drag.emplace_back(e.drag);
+        hits.emplace_back(e.hits);
+        shapeId.emplace_back((unsigned char) e.shapeId);
+        typeId.emplace_back((unsigned char) e.typeId);
+        reflects.emplace_back((unsigned char) e.reflects);
+        active.emplace_back((unsigned char) e.active);
+        ++revision;
+        return size() - 1;
+    }
+
+    /*!
+     * \brief Append many copies of an entity at once.
+     *
+     * Grows every array once instead of once per entity, the caller fills in the per entity fields afterwards.
+     * @param n number of entities
+     * @param e prototype to copy the fields from
+     * @return index of the first new entity
+     */
+    int addMany(int n, const Entity &e) {
+        int first = size();
+        int count = first + n;
+        ++revision;
+        pos.resize(count, e.pos);
+        f_pos.resize(count, e.pos);
+        p_pos.resize(count, e.pos);
+        vel.resize(count, e.vel);
+        width.resize(count, e.width);
+        height.resize(count, e.height);
+        radius.resize(count, e.radius);
+        drag.resize(count, e.drag);
+        hits.resize(count, e.hits);
+        shapeId.resize(count, (unsigned char) e.shapeId);
+        typeId.resize(count, (unsigned char) e.typeId);
+        reflects.resize(count, (unsigned char) e.reflects);
+        active.resize(count, (unsigned char) e.active);
+        return first;
+    }
+
+    /*!
+     * \brief Append many entities that only share some fields.
+     *
+     * Velocity, radius, drag, shape, type and flags are copied from the prototype. Position, future and previous
+     * position, size and hits are only grown, uninitialized, and left for the caller to write.
+     * @param n number of entities
+     * @param e prototype to copy the shared fields from
+     * @return index of the first new entity
+     */
+    int addUnplaced(int n, const Entity &e) {
+        int first = size();
+        int count = first + n;
+        ++revision;
+        pos.resize(count);
+        f_pos.resize(count);
+        p_pos.resize(count);
+        vel.resize(count, e.vel);
+        width.resize(count);
+        height.resize(count);
+        radius.resize(count, e.radius);
+        drag.resize(count, e.drag);
+        hits.resize(count);
+        shapeId.resize(count, (unsigned char) e.shapeId);
+        typeId.resize(count, (unsigned char) e.typeId);
+        reflects.resize(count, (unsigned char) e.reflects);
+        active.resize(count, (unsigned char) e.active);
+        return first;
+    }
+
+    /*!
+     * \brief Remove every entity of a type.
+     *
+     * Keeps the order of the remaining entities, so indices in front of the first removed entity stay valid.
+     * @param type type id to remove
+     */
+    void removeType(int type) {
+        int count = 0;
+        for (int i = 0; i < size(); ++i) {
+            if (typeId[i] == type) {
+                continue;
+            }
+            move(count, i);
+            ++count;
+        }
+        resize(count);
+    }
+
+    /*!
+     * \brief Remove the inactive entities of a type.
+     *
+     * Keeps the order of the remaining entities like removeType. Used to drop lost balls in one pass,
+     * so removing thousands of them costs a single sweep over the store.
+     * @param type type id to remove
+     */
+    void removeInactive(int type) {
+        int count = 0;
+        for (int i = 0; i < size(); ++i) {
+            if (typeId[i] == type && !active[i]) {
+                continue;
+            }
+            move(count, i);
+            ++count;
+        }
+        resize(count);
+    }
+
+    /*!
+     * \brief Remove every entity.
+     */
+    void clear() {
+        resize(0);
+    }
+
+private:
+    /*!
+     * Copy every field of entity from over entity to, nothing happens if they are the same.
+     */
+    void move(int to, int from) {
+        if (to == from) {
+            return;
+        }
+        pos[to] = pos[from];
+        f_pos[to] = f_pos[from];
+        p_pos[to] = p_pos[from];
+        vel[to] = vel[from];
+        width[to] = width[from];
+        height[to] = height[from];
+        radius[to] = radius[from];
+        drag[to] = drag[from];
+        hits[to] = hits[from];
+        shapeId[to] = shapeId[from];
+        typeId[to] = typeId[from];
+        reflects[to] = reflects[from];
+        active[to] = active[from];
+    }
+
+    void resize(int n) {
+        ++revision;
+        pos.resize(n);
+        f_pos.resize(n);
+        p_pos.resize(n);
+        vel.resize(n);
+        width.resize(n);
+        height.resize(n);
+        radius.resize(n);
+        drag.resize(n);
+        hits.resize(n);
+        shapeId.resize(n);
+        typeId.resize(n);
+        reflects.resize(n);
+        active.resize(n);
+    }
+};
+
+/*!
+ * \brief Thin reference to a single entity in an EntityStore.
+ *
+ * Used for entities the game logic addresses directly such as the player and the ball.
+ */
+struct EntityHandle {
+    EntityStore *store = NULL;  /**<  store holding the entity */
+    int id = -1;                /**<  index of the entity in the store */
+
+    EntityHandle() = default;
+
+    EntityHandle(EntityStore *s, int i) : store(s), id(i) {
+    }
+
+    Vector3D &pos() const { return store->pos[id]; }          /**<  position */
+    Vector3D &f_pos() const { return store->f_pos[id]; }      /**<  future position */
+    Vector3D &vel() const { return store->vel[id]; }          /**<  velocity */
+    float &width() const { return store->width[id]; }         /**<  rectangle width */
+    float &height() const { return store->height[id]; }       /**<  rectangle height */
+    float &radius() const { return store->radius[id]; }       /**<  circle radius */
+};
+
+#endif //MONOREPO_JSTRACESKI_ENTITYSTORE_H
@@ -0,0 +1,198 @@
+//
+// Created by jibbo on 3/22/21.
+//
+
+#ifndef MONOREPO_JSTRACESKI_FONTATLAS_H
+#define MONOREPO_JSTRACESKI_FONTATLAS_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+/*!
+ * \brief Structure to store character glyph data.
+ *
+ * Stores the location of the glyph in the font atlas, its width, height, and position offsets.
+ */
+struct Glyph {
+    unsigned int width = 0;     /**<  character width */
+    unsigned int height = 0;    /**<  character height */
+    int x = 0;                  /**<  offset to the bottom left of the glyph x */
+    int y = 0;                  /**<  offset to the bottom left of the glyph y */
+    long advance = 0;           /**<  advance to the next glyph */
+
+    int atlasX = 0;             /**<  left edge of the glyph bitmap in the atlas */
+    int atlasY = 0;             /**<  top edge of the glyph bitmap in the atlas */
+    float u0 = 0;               /**<  left texture coordinate */
+    float v0 = 0;               /**<  top texture coordinate */
+    float u1 = 0;               /**<  right texture coordinate */
+    float v1 = 0;               /**<  bottom texture coordinate */
+};
+
+/*!
+ * \brief Decode the next codepoint of a UTF-8 string.
+ *
+ * Bytes that don't start a valid sequence are taken as Latin-1 characters, so older Latin-1 text still shows.
+ * @param text UTF-8 text
+ * @param i byte index of the codepoint, moved past it
+ * @return codepoint
+ */
+inline uint32_t nextCodepoint(const std::string &text, size_t &i) {
+    unsigned char lead = (unsigned char) text[i];
+    int extra = 0;
+    uint32_t cp = lead;
+    if (lead >= 0xC2 && lead <= 0xDF) {
+        extra = 1;
+        cp = lead & 0x1F;
+    } else if (lead >= 0xE0 && lead <= 0xEF) {
+        extra = 2;
+        cp = lead & 0x0F;
+    } else if (lead >= 0xF0 && lead <= 0xF4) {
+        extra = 3;
+        cp = lead & 0x07;
+    }
+
+    if (extra == 0 || i + extra >= text.size()) {
+        ++i;
+        return lead;
+    }
+    for (int k = 1; k <= extra; ++k) {
+        unsigned char c = (unsigned char) text[i + k];
+        if ((c & 0xC0) != 0x80) {
+            ++i;
+            return lead;
+        }
+        cp = (cp << 6) | (c & 0x3F);
+    }
+
+    // overlong forms, surrogates and values past the last plane aren't valid either
+    static const uint32_t shortest[4] = {0, 0x80, 0x800, 0x10000};
+    if (cp < shortest[extra] || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) {
+        ++i;
+        return lead;
+    }
+    i += extra + 1;
+    return cp;
+}
+
+/*!
+ * \brief Single channel bitmap holding the rasterized glyphs of a font.
+ *
+ * Glyphs are rasterized with FreeType the first time a string needs them (see require) and packed
+ * left to right on shelves. The atlas doubles its height when it runs out of room, which changes the texture
+ * coordinates of every glyph, generation counts these resizes so laid out text knows to redo its quads.
+ * The atlas is CPU side only, the owner uploads the pixels to a texture and clears the dirty rows.
+ *
+ * Opened with a spread the atlas stores signed distance fields instead of coverage: 0.5 is the outline, larger
+ * values are inside and the field falls off to 0 and 1 spread pixels away from it. Thresholded with linear
+ * filtering the same glyphs stay sharp at any scale. Every glyph gets spread pixels of margin, which its
+ * offsets include, so text lays out the same in both modes.
+ */
+class FontAtlas {
+private:
+    static const int PADDING = 1;   /**<  empty pixels between glyphs so filtering doesn't bleed */
+    static const int DISTANCE_UPSCALE = 4;  /**<  outlines are rendered this much larger to measure distances */
+
+    FT_Library library = nullptr;   /**<  FreeType instance of the face */
+    FT_Face face = nullptr;         /**<  face glyphs are rasterized from, nullptr until open */
+
+    int shelfX = PADDING;           /**<  left edge of the next glyph on the current shelf */
+    int shelfY = PADDING;           /**<  top edge of the current shelf */
+    int shelfHeight = 0;            /**<  height of the tallest glyph on the current shelf */
+
+    std::unordered_map<uint32_t, Glyph> glyphs;     /**<  rasterized glyphs by codepoint */
+
+    /*!
+     * Reserve a rectangle in the atlas, growing it if needed.
+     * @param w rectangle width
+     * @param h rectangle height
+     * @param outX left edge of the reserved rectangle
+     * @param outY top edge of the reserved rectangle
+     */
+    void pack(int w, int h, int &outX, int &outY);
+
+    /*!
+     * Rasterize a glyph and pack it, codepoints missing in the face get an empty glyph.
+     * @param codepoint unicode codepoint
+     * @return false if FreeType failed to render it
+     */
+    bool rasterize(uint32_t codepoint);
+
+    /*!
+     * Turn the upscaled bitmap of the loaded glyph into a distance field.
+     * @param g glyph, gets its size and offsets in atlas pixels
+     * @param field distance values, g.width per row
+     */
+    void distanceField(Glyph &g, std::vector<unsigned char> &field) const;
+
+    /*!
+     * Recompute the texture coordinates of every glyph after the atlas grew.
+     */
+    void updateCoordinates();
+
+public:
+    int width = 512;                    /**<  atlas width in pixels */
+    int height = 0;                     /**<  atlas height in pixels */
+    std::vector<unsigned char> pixels;  /**<  coverage values, row major, width * height */
+
+    int spread = 0;         /**<  distance field range in atlas pixels, 0 for coverage glyphs */
+    int generation = 0;     /**<  incremented when the atlas grows and texture coordinates change */
+    int dirtyTop = 0;       /**<  first row written since markClean */
+    int dirtyBottom = 0;    /**<  row after the last row written since markClean, dirtyTop if none */
+
+    FontAtlas() = default;
+    FontAtlas(FontAtlas const&) = delete;       /**<  owns the FreeType face */
+    void operator=(FontAtlas const&) = delete;  /**<  Don't allow assignment. */
+    ~FontAtlas();
+
+    /*!
+     * \brief Open a font file, no glyph is rasterized yet.
+     * @param path system path to the font
+     * @param pixelSize glyph height in pixels
+     * @param distanceSpread distance field range in pixels, 0 to store coverage
+     * @return false if FreeType can't load the font
+     */
+    bool open(const char *path, int pixelSize, int distanceSpread = 0);
+
+    /*!
+     * \brief Free the FreeType face and the atlas.
+     */
+    void close();
+
+    /*!
+     * \brief Rasterize the glyphs of a string that aren't in the atlas yet.
+     * @param text UTF-8 text
+     * @return number of glyphs that failed to render
+     */
+    int require(const std::string &text);
+
+    /*!
+     * \brief Mark the atlas as uploaded.
+     */
+    void markClean() {
+        dirtyTop = dirtyBottom = 0;
+    }
+
+    /*!
+     * \brief Number of rasterized glyphs.
+     */
+    int size() const {
+        return (int) glyphs.size();
+    }
+
+    /*!
+     * \brief Glyph data of a codepoint.
+     * @param codepoint unicode codepoint
+     * @return glyph, all zero if the codepoint wasn't required yet
+     */
+    const Glyph &glyph(uint32_t codepoint) const {
+        static const Glyph missing;
+        auto it = glyphs.find(codepoint);
+        return it != glyphs.end() ? it->second : missing;
+    }
+};
+
+#endif //MONOREPO_JSTRACESKI_FONTATLAS_H
@@ -8,22 +8,34 @@
 #include <LOpenGL.h>
 #include <LTimer.h>
 #include <ResourceManager.h>
+#include <Audio.h>
+#include <World.h>
+#include <Replay.h>
+#include <StateHash.h>
+#include <Trajectory.h>
+#include <map>
+#include <SpriteBatch.h>
+#include <BrickRenderer.h>
 
 /**
  * \brief Window and Game Container.
  *
- * Initializes OpenGL/DevIL/Freetype library data and controls most game logic.
- * Gathers key input, parses game states, updates resulting states, and renders the result ot the screen.
+ * Initializes OpenGL/DevIL/Freetype library data and drives the World simulation.
+ * Gathers key input, steps the world, plays its sounds, and renders the result ot the screen.
+ * Owns the shared assets, the audio device and the world, and passes them to each other explicitly.
  */
 struct Game {
 private:
     /*!
-     * Render Entity States and Menu Objects stored in the ResourceManager.
+     * \brief Render Entity States and Menu Objects.
+     *
+     * Entities are drawn between their previous and current tick positions.
+     * @param alpha fraction of a tick elapsed since the last world step, 0 to 1
      */
-    void render();
+    void render(float alpha);
 
     /*!
-     * \brief Update ResourceManager key data and key state.
+     * \brief Update key data and menu state.
      *
      * Called every key event.
      * @param key keycode
@@ -36,6 +48,35 @@ private:
      */
     void input();
 
+    /*!
+     * \brief Update and store key state.
+     *
+     * Used to store the current state of a key irrespective of key-events.
+     * @param key keyboard keycode
+     * @param state true if the key is down, false otherwise
+     */
+    void updateKey(SDL_Keycode key, bool state);
+
+    /*!
+     * \brief Get the state of a key.
+     * @param key keyboard keycode
+     * @return true if the key is down, false is up
+     */
+    bool getKey(SDL_Keycode key);
+
+    /*!
+     * \brief Increment a menu selection index by i
+     * @param i index offset
+     */
+    void menuIncrement(int i);
+
+    /*!
+     * \brief Function called when enter is pressed and a menu is open.
+     *
+     * In this case it selects a language file to load and closes the menu.
+     */
+    void menuFunction();
+
     /*!
      * Initialize OpenGL data.
      * @return false if the init fails, true otherwise
@@ -50,10 +91,19 @@ private:
     bool loadMedia();
 
     /*!
-     * \brief Preform Physics and State Updates.
+     * \brief Step the world and play the sounds of the tick.
      */
     void update();
 
+    /*!
+     * \brief Run the world ticks owed for the time since the last frame.
+     *
+     * Real time is added to an accumulator that is drained in fixed ticks of 1 / TICK_RATE seconds.
+     * Long frames are clamped to MAX_FRAME_TIME so a slow frame can't snowball into more and more ticks.
+     * @return fraction of a tick left in the accumulator, used to interpolate rendering
+     */
+    float tick();
+
     /*!
      * \brief Syncs the rendering to cap the frame rate.
      */
@@ -61,35 +111,67 @@ private:
 
     /*!
      * \brief Close and delete all data.
-     * Calls the ResourceManager deconstruct to.
+     * Closes the audio device before the clips it plays are freed.
      */
     void close();
 
     bool quit = false; /**< quit flag */
 
     GLuint gProgramID = 0; /**< The window we'll be rendering to */
+    SpriteBatch spriteBatch; /**< batches entity shapes into a single draw */
+    GLuint brickProgramID = 0; /**< instanced brick shader program */
+    BrickRenderer brickRenderer; /**< draws the bricks from a persistent instance buffer */
+
+    TextLayout pauseText;               /**< message shown during a pause */
+    TextLayout scoreText;               /**< score of the HUD */
+    TextLayout levelText;               /**< level of the HUD */
+    TextLayout livesText;               /**< lives of the HUD */
+    std::vector<TextLayout> menuText;   /**< one layout per menu option */
     SDL_Window* gWindow = NULL; /**< SDL window pointer */
 
     SDL_GLContext gContext; /**< SDL OpenGL context */
 
     LTimer fpsTimer; /**< Fps capping timer */
 
+    ResourceManager resources;  /**< shared assets: font, sounds, text and level data */
+    Audio audio;                /**< audio device playing the sounds of the world */
+
+    World world;            /**< game simulation */
+    WorldInput worldInput;  /**< input state gathered for the next tick */
+
+    Replay replay;          /**< recording being made or played back */
+    bool recording = false; /**< record the ticks of the world into replay */
+    bool replaying = false; /**< drive the world from replay instead of the keyboard */
+    int replayTick = 0;     /**< next tick of the replay to play */
+
+    std::map<SDL_Keycode, bool> keyState;   /**< table to store persistent key states */
+    bool menu = false;                      /**< is the game in a menu state */
+    int menuIndex = 0;                      /**< menu selection index */
+
     int beforeTick; /**< last time from the timer */
     int afterTick; /**< current time from the timer */
 
+    Uint32 lastTickTime = 0;    /**< timer time of the last tick() call */
+    float accumulator = 0;      /**< seconds of real time not yet simulated */
+    const float MAX_FRAME_TIME = 0.25f; /**< longest frame time fed into the accumulator */
+
     const int SCREEN_FPS = 60; /**< Capped FPS */
     const int SCREEN_TICKS_PER_FRAME = 1000 / SCREEN_FPS; /**< ms ticks per frame */
+    const int MAX_HIT_VOICES = 8; /**< hit sounds started per tick at most */
+    const int FONT_SPREAD = 6; /**< distance field range of the font atlas in pixels, text is drawn up to 3x */
 
 public:
     static int SCREEN_WIDTH;    /**<  Screen Width */
     static int SCREEN_HEIGHT;   /**<  Screen Height */
+    static int TICK_RATE;       /**<  world ticks per second, independent of the frame rate */
 
-    static int BRICK_TOP_OFFSET;    /**<  offset between the top of the bricks and the top of the screen. */
-    static int BRICK_HEIGHT;        /**<  height of the brick on the screen */
-    static int BRICK_SPACING;       /**<  space between bricks */
+    std::string recordPath;     /**<  replay file the game is recorded to when the window closes, empty for none */
+    std::string replayPath;     /**<  replay file to play back at normal speed instead of reading the keyboard */
+    StateHashLog hashLog;       /**<  debug log or reference check of the state hash of every tick */
+    bool autopilot = false;     /**<  let pilot play instead of the a/d/space keys */
+    Autopilot pilot;            /**<  trajectory predicting paddle controller */
+    int multiBall = 0;          /**<  extra balls split off the ball on every serve, see WorldConfig::multiBall */
 
-    static float PADDLE_SPEED;      /**<  paddle speed added to the velocity of the paddle every tick */
-    static float MAX_SPEED;         /**<  ball and paddle max speed */
     Game();
 
     /*!
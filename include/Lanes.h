@@ -0,0 +1,280 @@
+//
+// Created by jibbo on 3/30/21.
+//
+
+#ifndef MONOREPO_JSTRACESKI_LANES_H
+#define MONOREPO_JSTRACESKI_LANES_H
+
+#include <cmath>
+#include <cstdint>
+
+/*!
+ * \file Lanes.h
+ * \brief Float vectors with one lane per independent value.
+ *
+ * Kernels written against Lanes run one scalar algorithm on Lanes::WIDTH values at once.
+ * The width depends on the build: 16 lanes of AVX-512 (BREAKJOE_AVX512), 8 lanes of AVX2 (BREAKJOE_AVX2),
+ * 8 lanes as two SSE2 registers on any other x86-64 build and 8 plain floats elsewhere.
+ * Comparisons return a LaneMask, which picks lanes with Select and converts to one bit per lane.
+ * Loads and stores expect LANES_ALIGNMENT aligned pointers.
+ */
+
+#if defined(__AVX512F__)
+    #include <immintrin.h>
+    #define BREAKJOE_LANES_AVX512
+#elif defined(__AVX2__)
+    #include <immintrin.h>
+    #define BREAKJOE_LANES_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define BREAKJOE_LANES_SSE2
+#endif
+
+static const int LANES_ALIGNMENT = 64;  /**<  alignment of lane arrays, enough for the widest kernel */
+
+#if defined(BREAKJOE_LANES_AVX512)
+
+struct Lanes {
+    static const int WIDTH = 16;    /**<  values per vector */
+    __m512 v;
+};
+
+struct LaneMask {
+    __mmask16 m;
+};
+
+inline Lanes LoadLanes(const float *p) { return {_mm512_load_ps(p)}; }
+inline void StoreLanes(float *p, Lanes a) { _mm512_store_ps(p, a.v); }
+inline Lanes SplatLanes(float f) { return {_mm512_set1_ps(f)}; }
+
+inline Lanes operator+(Lanes a, Lanes b) { return {_mm512_add_ps(a.v, b.v)}; }
+inline Lanes operator-(Lanes a, Lanes b) { return {_mm512_sub_ps(a.v, b.v)}; }
+inline Lanes operator*(Lanes a, Lanes b) { return {_mm512_mul_ps(a.v, b.v)}; }
+inline Lanes operator/(Lanes a, Lanes b) { return {_mm512_div_ps(a.v, b.v)}; }
+inline Lanes Min(Lanes a, Lanes b) { return {_mm512_min_ps(a.v, b.v)}; }
+inline Lanes Max(Lanes a, Lanes b) { return {_mm512_max_ps(a.v, b.v)}; }
+inline Lanes Sqrt(Lanes a) { return {_mm512_sqrt_ps(a.v)}; }
+
+inline LaneMask operator<(Lanes a, Lanes b) { return {_mm512_cmp_ps_mask(a.v, b.v, _CMP_LT_OQ)}; }
+inline LaneMask operator>(Lanes a, Lanes b) { return {_mm512_cmp_ps_mask(a.v, b.v, _CMP_GT_OQ)}; }
+inline LaneMask operator!=(Lanes a, Lanes b) { return {_mm512_cmp_ps_mask(a.v, b.v, _CMP_NEQ_OQ)}; }
+
+inline LaneMask operator&(LaneMask a, LaneMask b) { return {(__mmask16) (a.m & b.m)}; }
+inline LaneMask operator|(LaneMask a, LaneMask b) { return {(__mmask16) (a.m | b.m)}; }
+inline LaneMask operator~(LaneMask a) { return {(__mmask16) ~a.m}; }
+
+inline Lanes Select(LaneMask m, Lanes a, Lanes b) { return {_mm512_mask_blend_ps(m.m, b.v, a.v)}; }
+inline uint32_t MaskBits(LaneMask m) { return m.m; }
+inline LaneMask MaskFromBits(uint32_t bits) { return {(__mmask16) bits}; }
+
+#elif defined(BREAKJOE_LANES_AVX2)
+
+struct Lanes {
+    static const int WIDTH = 8;     /**<  values per vector */
+    __m256 v;
+};
+
+struct LaneMask {
+    __m256 m;   /**<  all bits set in selected lanes */
+};
+
+inline Lanes LoadLanes(const float *p) { return {_mm256_load_ps(p)}; }
+inline void StoreLanes(float *p, Lanes a) { _mm256_store_ps(p, a.v); }
+inline Lanes SplatLanes(float f) { return {_mm256_set1_ps(f)}; }
+
+inline Lanes operator+(Lanes a, Lanes b) { return {_mm256_add_ps(a.v, b.v)}; }
+inline Lanes operator-(Lanes a, Lanes b) { return {_mm256_sub_ps(a.v, b.v)}; }
+inline Lanes operator*(Lanes a, Lanes b) { return {_mm256_mul_ps(a.v, b.v)}; }
+inline Lanes operator/(Lanes a, Lanes b) { return {_mm256_div_ps(a.v, b.v)}; }
+inline Lanes Min(Lanes a, Lanes b) { return {_mm256_min_ps(a.v, b.v)}; }
+inline Lanes Max(Lanes a, Lanes b) { return {_mm256_max_ps(a.v, b.v)}; }
+inline Lanes Sqrt(Lanes a) { return {_mm256_sqrt_ps(a.v)}; }
+
+inline LaneMask operator<(Lanes a, Lanes b) { return {_mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ)}; }
+inline LaneMask operator>(Lanes a, Lanes b) { return {_mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ)}; }
+inline LaneMask operator!=(Lanes a, Lanes b) { return {_mm256_cmp_ps(a.v, b.v, _CMP_NEQ_OQ)}; }
+
+inline LaneMask operator&(LaneMask a, LaneMask b) { return {_mm256_and_ps(a.m, b.m)}; }
+inline LaneMask operator|(LaneMask a, LaneMask b) { return {_mm256_or_ps(a.m, b.m)}; }
+inline LaneMask operator~(LaneMask a) { return {_mm256_xor_ps(a.m, _mm256_castsi256_ps(_mm256_set1_epi32(-1)))}; }
+
+inline Lanes Select(LaneMask m, Lanes a, Lanes b) { return {_mm256_blendv_ps(b.v, a.v, m.m)}; }
+inline uint32_t MaskBits(LaneMask m) { return (uint32_t) _mm256_movemask_ps(m.m); }
+inline LaneMask MaskFromBits(uint32_t bits) {
+    const __m256i lane = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+    __m256i set = _mm256_and_si256(_mm256_set1_epi32((int) bits), lane);
+    return {_mm256_castsi256_ps(_mm256_cmpeq_epi32(set, lane))};
+}
+
+#elif defined(BREAKJOE_LANES_SSE2)
+
+struct Lanes {
+    static const int WIDTH = 8;     /**<  values per vector, two registers keep the layout of the AVX2 build */
+    __m128 lo;
+    __m128 hi;
+};
+
+struct LaneMask {
+    __m128 lo;  /**<  all bits set in selected lanes 0-3 */
+    __m128 hi;  /**<  all bits set in selected lanes 4-7 */
+};
+
+inline Lanes LoadLanes(const float *p) { return {_mm_load_ps(p), _mm_load_ps(p + 4)}; }
+inline void StoreLanes(float *p, Lanes a) { _mm_store_ps(p, a.lo); _mm_store_ps(p + 4, a.hi); }
+inline Lanes SplatLanes(float f) { return {_mm_set1_ps(f), _mm_set1_ps(f)}; }
+
+inline Lanes operator+(Lanes a, Lanes b) { return {_mm_add_ps(a.lo, b.lo), _mm_add_ps(a.hi, b.hi)}; }
+inline Lanes operator-(Lanes a, Lanes b) { return {_mm_sub_ps(a.lo, b.lo), _mm_sub_ps(a.hi, b.hi)}; }
+inline Lanes operator*(Lanes a, Lanes b) { return {_mm_mul_ps(a.lo, b.lo), _mm_mul_ps(a.hi, b.hi)}; }
+inline Lanes operator/(Lanes a, Lanes b) { return {_mm_div_ps(a.lo, b.lo), _mm_div_ps(a.hi, b.hi)}; }
+inline Lanes Min(Lanes a, Lanes b) { return {_mm_min_ps(a.lo, b.lo), _mm_min_ps(a.hi, b.hi)}; }
+inline Lanes Max(Lanes a, Lanes b) { return {_mm_max_ps(a.lo, b.lo), _mm_max_ps(a.hi, b.hi)}; }
+inline Lanes Sqrt(Lanes a) { return {_mm_sqrt_ps(a.lo), _mm_sqrt_ps(a.hi)}; }
+
+inline LaneMask operator<(Lanes a, Lanes b) { return {_mm_cmplt_ps(a.lo, b.lo), _mm_cmplt_ps(a.hi, b.hi)}; }
+inline LaneMask operator>(Lanes a, Lanes b) { return {_mm_cmpgt_ps(a.lo, b.lo), _mm_cmpgt_ps(a.hi, b.hi)}; }
+inline LaneMask operator!=(Lanes a, Lanes b) { return {_mm_cmpneq_ps(a.lo, b.lo), _mm_cmpneq_ps(a.hi, b.hi)}; }
+
+inline LaneMask operator&(LaneMask a, LaneMask b) { return {_mm_and_ps(a.lo, b.lo), _mm_and_ps(a.hi, b.hi)}; }
+inline LaneMask operator|(LaneMask a, LaneMask b) { return {_mm_or_ps(a.lo, b.lo), _mm_or_ps(a.hi, b.hi)}; }
+inline LaneMask operator~(LaneMask a) {
+    __m128 ones = _mm_castsi128_ps(_mm_set1_epi32(-1));
+    return {_mm_xor_ps(a.lo, ones), _mm_xor_ps(a.hi, ones)};
+}
+
+inline Lanes Select(LaneMask m, Lanes a, Lanes b) {
+    return {_mm_or_ps(_mm_and_ps(m.lo, a.lo), _mm_andnot_ps(m.lo, b.lo)),
+            _mm_or_ps(_mm_and_ps(m.hi, a.hi), _mm_andnot_ps(m.hi, b.hi))};
+}
+inline uint32_t MaskBits(LaneMask m) {
+    return (uint32_t) _mm_movemask_ps(m.lo) | ((uint32_t) _mm_movemask_ps(m.hi) << 4);
+}
+inline LaneMask MaskFromBits(uint32_t bits) {
+    const __m128i lane = _mm_setr_epi32(1, 2, 4, 8);
+    __m128i lo = _mm_and_si128(_mm_set1_epi32((int) bits), lane);
+    __m128i hi = _mm_and_si128(_mm_set1_epi32((int) (bits >> 4)), lane);
+    return {_mm_castsi128_ps(_mm_cmpeq_epi32(lo, lane)), _mm_castsi128_ps(_mm_cmpeq_epi32(hi, lane))};
+}
+
+#else
+
+struct Lanes {
+    static const int WIDTH = 8;     /**<  values per vector */
+    float v[8];
+};
+
+struct LaneMask {
+    uint32_t m; /**<  one bit per selected lane */
+};
+
+inline Lanes LoadLanes(const float *p) {
+    Lanes r;
+    for (int i = 0; i < Lanes::WIDTH; ++i) r.v[i] = p[i];
+    return r;
+}
+inline void StoreLanes(float *p, Lanes a) {
+    for (int i = 0; i < Lanes::WIDTH; ++i) p[i] = a.v[i];
+}
+inline Lanes SplatLanes(float f) {
+    Lanes r;
+    for (int i = 0; i < Lanes::WIDTH; ++i) r.v[i] = f;
+    return r;
+}
+
+#define BREAKJOE_LANES_BINARY(name, expr) \
+    inline Lanes name(Lanes a, Lanes b) { \
+        Lanes r; \
+        for (int i = 0; i < Lanes::WIDTH; ++i) r.v[i] = (expr); \
+        return r; \
+    }
+BREAKJOE_LANES_BINARY(operator+, a.v[i] + b.v[i])
+BREAKJOE_LANES_BINARY(operator-, a.v[i] - b.v[i])
+BREAKJOE_LANES_BINARY(operator*, a.v[i] * b.v[i])
+BREAKJOE_LANES_BINARY(operator/, a.v[i] / b.v[i])
+BREAKJOE_LANES_BINARY(Min, a.v[i] < b.v[i] ? a.v[i] : b.v[i])
+BREAKJOE_LANES_BINARY(Max, a.v[i] > b.v[i] ? a.v[i] : b.v[i])
+#undef BREAKJOE_LANES_BINARY
+
+inline Lanes Sqrt(Lanes a) {
+    Lanes r;
+    for (int i = 0; i < Lanes::WIDTH; ++i) r.v[i] = sqrtf(a.v[i]);
+    return r;
+}
+
+#define BREAKJOE_LANES_COMPARE(name, op) \
+    inline LaneMask name(Lanes a, Lanes b) { \
+        LaneMask r = {0}; \
+        for (int i = 0; i < Lanes::WIDTH; ++i) r.m |= (uint32_t) (a.v[i] op b.v[i]) << i; \
+        return r; \
+    }
+BREAKJOE_LANES_COMPARE(operator<, <)
+BREAKJOE_LANES_COMPARE(operator>, >)
+BREAKJOE_LANES_COMPARE(operator!=, !=)
+#undef BREAKJOE_LANES_COMPARE
+
+inline LaneMask operator&(LaneMask a, LaneMask b) { return {a.m & b.m}; }
+inline LaneMask operator|(LaneMask a, LaneMask b) { return {a.m | b.m}; }
+inline LaneMask operator~(LaneMask a) { return {~a.m & 0xFFu}; }
+
+inline Lanes Select(LaneMask m, Lanes a, Lanes b) {
+    Lanes r;
+    for (int i = 0; i < Lanes::WIDTH; ++i) r.v[i] = (m.m >> i) & 1u ? a.v[i] : b.v[i];
+    return r;
+}
+inline uint32_t MaskBits(LaneMask m) { return m.m; }
+inline LaneMask MaskFromBits(uint32_t bits) { return {bits & 0xFFu}; }
+
+#endif
+
+/*!
+ * \brief Name of the lane kernels compiled in, "avx512", "avx2", "sse2" or "scalar".
+ */
+inline const char *LanesKernel() {
+#if defined(BREAKJOE_LANES_AVX512)
+    return "avx512";
+#elif defined(BREAKJOE_LANES_AVX2)
+    return "avx2";
+#elif defined(BREAKJOE_LANES_SSE2)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+// TinyMath.hpp on 2D lane vectors, same formulas so batched and scalar worlds round the same way
+
+/*!
+ * \brief Dot product of two lane vectors.
+ */
+inline Lanes Dot(Lanes ax, Lanes ay, Lanes bx, Lanes by) {
+    return ax * bx + ay * by;
+}
+
+/*!
+ * \brief Length of a lane vector.
+ */
+inline Lanes Magnitude(Lanes x, Lanes y) {
+    return Sqrt(Dot(x, y, x, y));
+}
+
+/*!
+ * \brief Set the length of a lane vector to 1, zero vectors are left as is.
+ */
+inline void Normalize(Lanes &x, Lanes &y) {
+    Lanes mag = Magnitude(x, y);
+    LaneMask nonZero = mag != SplatLanes(0);
+    x = Select(nonZero, x / mag, x);
+    y = Select(nonZero, y / mag, y);
+}
+
+/*!
+ * \brief Projection of a onto b, b must not be zero.
+ */
+inline void Project(Lanes ax, Lanes ay, Lanes bx, Lanes by, Lanes &outX, Lanes &outY) {
+    Lanes mag = Magnitude(bx, by);
+    Lanes s = Dot(ax, ay, bx / mag, by / mag);
+    outX = bx * s;
+    outY = by * s;
+}
+
+#endif //MONOREPO_JSTRACESKI_LANES_H
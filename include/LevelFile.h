@@ -0,0 +1,192 @@
+//
+// Created by jibbo on 3/26/21.
+//
+
+#ifndef MONOREPO_JSTRACESKI_LEVELFILE_H
+#define MONOREPO_JSTRACESKI_LEVELFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct WorldConfig;
+
+// directory the build writes the compiled bundled levels to, see the levels target
+#ifndef BREAKJOE_COMPILED_LEVEL_DIR
+#define BREAKJOE_COMPILED_LEVEL_DIR "Assets"
+#endif
+
+static const uint32_t LEVEL_FILE_VERSION = 1;   /**<  bumped whenever the layout below changes */
+static const uint32_t LEVEL_HAS_RECTS = 1;      /**<  header flag, brick rectangles follow the hit counts */
+
+/*!
+ * \brief Header of a compiled level file (.bjl).
+ *
+ * The file is the header, then rows uint32 cell counts, then one uint8 hit count per cell padded to 4 bytes,
+ * then optionally bricks * 4 floats (center x, center y, width, height) in cell order.
+ * Values are stored in native byte order, the file is meant to be built on the machine that plays it.
+ */
+struct LevelFileHeader {
+    char magic[4];          /**<  "BJLV" */
+    uint32_t version;       /**<  LEVEL_FILE_VERSION */
+    uint32_t rows;          /**<  number of rows */
+    uint32_t cells;         /**<  cells in all rows */
+    uint32_t bricks;        /**<  cells with a hit count above 0 */
+    uint32_t flags;         /**<  LEVEL_HAS_RECTS */
+
+    int32_t screenWidth;    /**<  config the rectangles were computed for */
+    int32_t screenHeight;   /**<  config the rectangles were computed for */
+    int32_t brickTopOffset; /**<  config the rectangles were computed for */
+    int32_t brickHeight;    /**<  config the rectangles were computed for */
+    int32_t brickSpacing;   /**<  config the rectangles were computed for */
+    uint32_t reserved;      /**<  keeps the header a multiple of 8 bytes */
+};
+
+/*!
+ * \brief Parsed level grid.
+ *
+ * Only points at the data, which is owned by a LevelFile mapping or by the vectors of a text parse.
+ */
+struct LevelLayout {
+    uint32_t rows = 0;                  /**<  number of rows */
+    uint32_t cells = 0;                 /**<  cells in all rows */
+    uint32_t bricks = 0;                /**<  cells with a hit count above 0 */
+    const uint32_t *rowCols = nullptr;  /**<  cells in each row */
+    const uint8_t *hits = nullptr;      /**<  hit count of each cell, row major */
+    const float *rects = nullptr;       /**<  brick rectangles, nullptr if they have to be computed */
+    const LevelFileHeader *header = nullptr; /**<  file header, nullptr for text levels */
+
+    /*!
+     * \brief Check if the precomputed rectangles match a config.
+     * @return true if rects can be used as is
+     */
+    bool rectsMatch(const WorldConfig &config) const;
+};
+
+/*!
+ * \brief Owning storage for a level parsed from text.
+ */
+struct LevelText {
+    std::vector<uint32_t> rowCols;  /**<  cells in each row */
+    std::vector<uint8_t> hits;      /**<  hit count of each cell */
+    uint32_t bricks = 0;            /**<  cells with a hit count above 0 */
+
+    /*!
+     * \brief Parse the text level format, one row per line, one digit per cell.
+     *
+     * Spaces and carriage returns are ignored, any other non digit is an empty cell.
+     * @param str level data
+     */
+    void parse(const std::string &str);
+
+    /*!
+     * \brief View of the parsed level, valid until the next parse.
+     */
+    LevelLayout layout() const;
+};
+
+/*!
+ * \brief Read only memory mapping of a compiled level file.
+ */
+class LevelFile {
+private:
+    void *data = nullptr;   /**<  start of the mapping */
+    size_t size = 0;        /**<  length of the mapping */
+    LevelLayout view;       /**<  layout pointing into the mapping */
+
+public:
+    LevelFile() = default;
+    LevelFile(LevelFile const&) = delete;       /**<  owns the mapping */
+    void operator=(LevelFile const&) = delete;  /**<  Don't allow assignment. */
+
+    ~LevelFile() {
+        close();
+    }
+
+    /*!
+     * \brief Map a compiled level file and validate its header.
+     * @param path system path to the .bjl file
+     * @return false if the file can't be mapped or isn't a valid level, true otherwise
+     */
+    bool open(const std::string &path);
+
+    /*!
+     * \brief Unmap the file, invalidates the layout.
+     */
+    void close();
+
+    /*!
+     * \brief Layout of the mapped level.
+     */
+    const LevelLayout &layout() const {
+        return view;
+    }
+};
+
+/*!
+ * \brief Read only level data shared by every world.
+ *
+ * Keeps the mappings of compiled levels and the parsed text levels alive, worlds only hold LevelLayout views
+ * into it. One library can back any number of worlds on any number of threads, as long as nothing is loaded
+ * or cleared while they run.
+ */
+class LevelLibrary {
+private:
+    std::vector<std::unique_ptr<LevelFile>> files;  /**<  mappings of the compiled levels */
+    std::vector<std::unique_ptr<LevelText>> texts;  /**<  parsed text levels */
+    std::vector<LevelLayout> views;                 /**<  layout of every level in load order */
+
+public:
+    LevelLibrary() = default;
+    LevelLibrary(LevelLibrary const&) = delete;     /**<  layouts point into the owned data */
+    void operator=(LevelLibrary const&) = delete;   /**<  Don't allow assignment. */
+
+    /*!
+     * \brief Append a level, .bjl files are memory mapped, anything else is parsed as text.
+     * @param path system path to the level file
+     * @return false if the level can't be read, true otherwise
+     */
+    bool load(const std::string &path);
+
+    /*!
+     * \brief Append a level from its compiled file if that is up to date, from its text file otherwise.
+     *
+     * A compiled file older than the text or one that doesn't open, like one written for another
+     * LEVEL_FILE_VERSION, falls back to the text.
+     * @param compiledPath system path to the .bjl file, doesn't have to exist
+     * @param textPath system path to the text level
+     * @return false if neither can be read, true otherwise
+     */
+    bool loadNewest(const std::string &compiledPath, const std::string &textPath);
+
+    /*!
+     * \brief Drop every level, invalidates the layouts.
+     */
+    void clear();
+
+    /*!
+     * \brief Layouts of the loaded levels in load order, valid until clear.
+     */
+    const std::vector<LevelLayout> &layouts() const {
+        return views;
+    }
+};
+
+/*!
+ * \brief Check the extension of a level path.
+ * @return true if the path names a compiled level file
+ */
+bool isCompiledLevel(const std::string &path);
+
+/*!
+ * \brief Write a level in the compiled format.
+ * @param path output path
+ * @param layout level grid
+ * @param rectConfig config to precompute the brick rectangles for, nullptr to leave them out
+ * @return false if the file couldn't be written, true otherwise
+ */
+bool writeLevelFile(const std::string &path, const LevelLayout &layout, const WorldConfig *rectConfig);
+
+#endif //MONOREPO_JSTRACESKI_LEVELFILE_H
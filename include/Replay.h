@@ -0,0 +1,124 @@
+//
+// Created by jibbo on 3/31/21.
+//
+
+#ifndef MONOREPO_JSTRACESKI_REPLAY_H
+#define MONOREPO_JSTRACESKI_REPLAY_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <World.h>
+
+static const uint32_t REPLAY_FILE_VERSION = 4;  /**<  bumped whenever the layout below, the state hash or the rules change */
+static const uint32_t REPLAY_HAS_HASHES = 1;    /**<  header flag, a state hash per tick follows the inputs */
+
+static const uint8_t REPLAY_LEFT = 1;           /**<  input bit of WorldInput::left */
+static const uint8_t REPLAY_RIGHT = 2;          /**<  input bit of WorldInput::right */
+static const uint8_t REPLAY_SHOOT = 4;          /**<  input bit of WorldInput::shoot */
+
+/*!
+ * \brief Header of a replay file (.bjr).
+ *
+ * The file is the header, then one input byte per tick padded to 8 bytes,
+ * then optionally one uint64 state hash per tick (hashWorldState after the tick).
+ * Values are stored in native byte order.
+ */
+struct ReplayHeader {
+    char magic[4];          /**<  "BJRP" */
+    uint32_t version;       /**<  REPLAY_FILE_VERSION */
+    uint32_t flags;         /**<  REPLAY_HAS_HASHES */
+    uint32_t ticks;         /**<  recorded ticks */
+    uint32_t seed;          /**<  seed of the input source, bots store their policy seed, 0 for keyboard play */
+    int32_t levelId;        /**<  level the recording starts on */
+    uint32_t levelCount;    /**<  number of levels in play order */
+    int32_t tickRate;       /**<  WorldConfig::tickRate */
+    int32_t screenWidth;    /**<  WorldConfig::screenWidth */
+    int32_t screenHeight;   /**<  WorldConfig::screenHeight */
+    int32_t multiBall;      /**<  WorldConfig::multiBall */
+    uint32_t reserved;      /**<  0, keeps levelHash 8 byte aligned */
+    uint64_t levelHash;     /**<  hash of the level data, replays only reproduce on the same levels */
+};
+
+/*!
+ * \brief Per tick input of a game with the state hash after every tick.
+ *
+ * A recording starts on a freshly loaded level and stores the WorldInput of every World::step.
+ * The world is deterministic, so stepping a world set up with setUp through the same inputs reproduces it
+ * bit for bit, which the stored hashes check tick by tick.
+ */
+class Replay {
+public:
+    ReplayHeader header;            /**<  recording settings */
+    std::vector<uint8_t> inputs;    /**<  REPLAY_ input bits of every tick */
+    std::vector<uint64_t> hashes;   /**<  state hash after every tick, empty if not recorded */
+
+    Replay();
+
+    /*!
+     * \brief Start a recording of a world that just loaded its level.
+     * @param world world about to be stepped
+     * @param seed seed of the input source
+     */
+    void begin(const World &world, uint32_t seed);
+
+    /*!
+     * \brief Append a tick.
+     * @param in input the world was stepped with
+     * @param world world after the step
+     */
+    void record(const WorldInput &in, const World &world);
+
+    /*!
+     * \brief Number of recorded ticks.
+     */
+    int ticks() const {
+        return (int) inputs.size();
+    }
+
+    /*!
+     * \brief Input of a tick.
+     * @param tick tick index
+     */
+    WorldInput input(int tick) const;
+
+    /*!
+     * \brief Check the world against the hash recorded after a tick.
+     * @param tick tick index
+     * @param world world after stepping the tick
+     * @return true if it matches or no hashes were recorded
+     */
+    bool check(int tick, const World &world) const;
+
+    /*!
+     * \brief Configure a world and load the first level of the recording.
+     *
+     * The world must be fresh (not started up), its levels have to be set to the levels of the recording.
+     * @param world world to set up
+     * @return false if the levels don't match the recording, true otherwise
+     */
+    bool setUp(World &world) const;
+
+    /*!
+     * \brief Write the replay to a file.
+     * @param path output path
+     * @return false if the file couldn't be written, true otherwise
+     */
+    bool save(const std::string &path) const;
+
+    /*!
+     * \brief Read a replay file.
+     * @param path system path to the .bjr file
+     * @return false if the file can't be read or isn't a valid replay, true otherwise
+     */
+    bool load(const std::string &path);
+};
+
+/*!
+ * \brief Hash of the level data of a play order.
+ * @param levels levels in play order
+ * @return 64 bit hash
+ */
+uint64_t hashLevels(const std::vector<LevelLayout> &levels);
+
+#endif //MONOREPO_JSTRACESKI_REPLAY_H
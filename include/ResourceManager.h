@@ -9,71 +9,46 @@
 #include <LOpenGL.h>
 #include <vector>
 #include <cstring>
-#include <Entity.h>
+#include <EntityStore.h>
+#include <SpriteBatch.h>
+#include <FontAtlas.h>
+#include <TextLayout.h>
 #include <Clip.h>
-#include "Game.h"
+#include <LevelFile.h>
 
 /*!
- * \brief Structure to store character texture data.
+ * \brief Shared read only game assets.
  *
- * Stores the texture id, width, height, and position of the character glyph.
- */
-struct Glyph {
-    unsigned int texId;     /**<  texture id of the glyph */
-    unsigned int width;     /**<  character width */
-    unsigned int height;    /**<  character height */
-    int x;                  /**<  offset to the bottom left of the glyph x */
-    int y;                  /**<  offset to the bottom left of the glyph y */
-    long advance;            /**<  advance to the next glyph */
-};
-
-/*!
- * \brief Singleton to represent all game data.
- *
- * Stores Character Textures, Sound Clips, Key-States, Message Text, Level Lookup.
+ * Stores the font atlas, Sound Clips, Message Text and the Level data.
+ * Loaded once and then only read, so any number of worlds, audio devices and renderers can use one copy.
+ * Per game state lives in World, playback state in Audio and input state in Game.
  */
 class ResourceManager {
 private:
-    ResourceManager();                      /**<  Private Constructor */
-    ResourceManager(ResourceManager const&); /**<  Avoid copy constructor */
-    void operator=(ResourceManager const&); /**<  Don't allow assignment. */
-
-    std::map<char, Glyph> glyphLookup;                  /**<  character glyph lookup */
+    FontAtlas font;                                     /**<  rasterized glyphs of the loaded font */
+    GLuint fontTexture = 0;                             /**<  texture holding the font atlas */
+    int fontTextureHeight = 0;                          /**<  atlas height the texture was allocated with */
     std::map<std::string, std::string> messageLookup;   /**<  display message lookup table */
     std::map<std::string, Clip*> soundLookup;           /**<  sound clip lookup table */
-    std::vector<std::string> levels;                    /**<  level save data lookup table */
+    std::vector<Clip*> sounds;                          /**<  loaded clips, owned */
+    LevelLibrary levels;                                /**<  level data in play order */
     std::map<std::string, std::string> menuLookup;      /**<  lookup table for menu options to language files */
-    std::map<SDL_Keycode, bool> keyState;               /**<  table to store persistent key states */
 
-public:
+    /*!
+     * Upload the atlas rows written since the last upload.
+     *
+     * When the atlas grew the batch is flushed first, its queued glyphs use the coordinates of the old size.
+     * @param batch sprite batch of the frame
+     */
+    void updateFontTexture(SpriteBatch &batch);
 
-    std::vector<Entity *> entities;     /**<  entity display and physics list */
+public:
 
     std::vector<std::string> menuOptions;   /**<  language menu option lists */
-    int menuIndex = 0;                      /**<  menu selection index */
-
-    Entity* player; /**<  player entity pointer */
-    Entity* ball;   /**<  ball entity pointer */
-
-    int levelId = 0;        /**<  current level id */
-    int playerLives = 3;    /**<  number of player lives */
-    int score = 0;          /**<  current score */
-
-    float pauseTimer = 0;           /**<  pause timer */
-    float PAUSE_DELAY = 3;          /**<  default pause delay */
-    std::string pauseText = "";     /**<  pause text string */
-
-    bool end = false;           /**<  game over */
-    bool menu = false;          /**<  is the game in a menu state */
-    bool ballCaptured = true;   /**<  is the ball captured on the paddle */
 
-    Vector3D shootVector = Vector3D(0, 2, 0); /**<  initial velocity when shooting the ball from the paddle */
-
-    /*!
-     * \brief Obtain the static instance.
-     * @return static instance of Resource Manager
-     */
-    static ResourceManager *getInstance();
+    ResourceManager() = default;
+    ResourceManager(ResourceManager const&) = delete;   /**<  owns the clips and the font texture */
+    void operator=(ResourceManager const&) = delete;    /**<  Don't allow assignment. */
 
     /*!
      * \brief Load a sound file from a path.
@@ -87,23 +62,25 @@ public:
     Clip* loadSound(const char * path, const std::string& key);
 
     /*!
-     * \brief Queue the sound clip to play.
+     * \brief Obtain a sound clip from a key.
      *
      * Key is a reference to the string used when loadSound is called.
-     *
      * @param key lookup string
+     * @return the clip, nullptr for unknown keys
      */
-    void playSound(const std::string& key);
+    Clip* getSound(const std::string& key);
 
 
     /*!
      * \brief Load font graphics from path.
      *
-     * @param ft Freetype library instance
+     * Glyphs are rasterized into the atlas the first time a string uses them. With a spread the atlas stores
+     * distance fields, which are filtered linearly and stay sharp at every text scale.
      * @param path system path to the ttf file
+     * @param spread distance field range in pixels, 0 for coverage glyphs
      * @return 0 if the font fails to load, 1 otherwise
      */
-    int loadFont(FT_Library ft, const char * path);
+    int loadFont(const char * path, int spread = 0);
 
     /*!
      * \brief Load language strings from a text file.
@@ -118,82 +95,66 @@ public:
      *
      * This is used so that text can be mapped by a key and loaded by a language file.
      * @param key reference key
-     * @return referenced text
-     */
-    std::string getText(const std::string& key);
-
-
-    /*!
-     * \brief Update and store key state.
-     *
-     * Used to store the current state of a key irrespective of key-events.
-     * @param key keyboard keycode
-     * @param state true if the key is down, false otherwise
-     */
-    void updateKey(SDL_Keycode key, bool state);
-
-    /*!
-     * \brief Get the state of a key.
-     * @param key keyboard keycode
-     * @return true if the key is down, false is up
+     * @return referenced text, valid until the language changes
      */
-    bool getKey(SDL_Keycode key);
-
+    const std::string& getText(const std::string& key) const;
 
     /*!
-     * \brief Clear all bricks from the entity vector, leaves players and balls.
+     * \brief Glyph atlas of the loaded font, used to lay out text ahead of drawing it.
      */
-    void clearLevel();
+    FontAtlas& getFont() {
+        return font;
+    }
 
-    /*!
-     * \brief Load level data from a file path.
-     *
-     * Level data is stored in lines where numbers represent how many hits a brick can take. i.e.
-     *  0123210 represents a row of ascending and descending brick values surround by empty space.
-     *
-     * @param path system path to the level file
-     */
-    void loadLevel(std::string path);
 
     /*!
-     * \brief Update the current level state.
-     * @param win true if the level was won, false otherwise
+     * \brief Load the language file of a menu option.
+     * @param option index into menuOptions
      */
-    void levelUpdate(bool win);
-
+    void selectLanguage(int option);
 
-    /*!
-     * \brief Increment a menu selection index by i
-     * @param i index offset
-     */
-    void menuIncrement(int i);
 
     /*!
-     * \brief Function called when enter is pressed and a menu is open.
+     * \brief Level layouts in play order.
      *
-     * In this case it selects a language file to load.
+     * The layouts stay valid until shutDown, worlds can keep copies of them.
+     * @return level layouts
      */
-    void menuFunction();
+    const std::vector<LevelLayout>& getLevels();
 
 
     /*!
-     * \brief Draw text to the screen.
+     * \brief Queue text in the sprite batch.
      *
      * Draws the text at the given position, size scale, and alignment.
-     * The alignment is where the text is drawn from.
+     * The alignment is where the text is drawn from. Every glyph comes from the font atlas,
+     * so a string only adds quads to the current batch. Glyphs used for the first time are rasterized.
      *
-     * @param text render string
+     * @param batch sprite batch of the frame
+     * @param text UTF-8 render string
      * @param pos text position
      * @param scale text size
      * @param alignment left/center/right -> 0/1/2
      */
-    void drawText(const std::string& text, const Vector3D &pos, float scale, int alignment);
+    void drawText(SpriteBatch &batch, const std::string& text, const Vector3D &pos, float scale, int alignment);
 
     /*!
-     * \brief Draw entity to the screen.
-     * @param e entity reference
+     * \brief Queue text laid out ahead of time in the sprite batch.
+     *
+     * Only copies the stored glyph quads, see TextLayout. They are laid out again if the atlas grew.
+     * @param batch sprite batch of the frame
+     * @param layout text laid out with the font of getFont
      */
-    static void drawEntity(const Entity *e);
+    void drawText(SpriteBatch &batch, TextLayout &layout);
+
+    /*!
+     * \brief Queue an entity in the sprite batch.
+     * @param batch sprite batch of the frame
+     * @param store entity store
+     * @param id entity index
+     * @param alpha interpolation between the previous (0) and current (1) tick position
+     */
+    static void drawEntity(SpriteBatch &batch, const EntityStore &store, int id, float alpha);
 
 
     /*!
@@ -204,6 +165,8 @@ public:
 
     /*!
      * \brief Dereference all pointers and clean up data.
+     *
+     * Audio devices playing the clips have to be closed first.
      * @return 0 if the data is deleted, 1 otherwise
      */
     int shutDown();
@@ -0,0 +1,117 @@
+//
+// Created by jibbo on 4/3/21.
+//
+
+#ifndef MONOREPO_JSTRACESKI_SCENEDRAW_H
+#define MONOREPO_JSTRACESKI_SCENEDRAW_H
+
+#include <string>
+#include <EntityStore.h>
+#include <FontAtlas.h>
+#include <TextLayout.h>
+#include <World.h>
+
+/*
+ * Scene drawing shared by the render backends.
+ *
+ * A Canvas is anything with setColor(r, g, b), drawRect(x, y, w, h), drawCircle(x, y, radius) and
+ * drawQuad(left, bottom, right, top, u0, v0, u1, v1) taking pixel coordinates with y pointing up:
+ * SpriteBatch for the window, SoftRaster for headless frames. Keeping the scene here makes both draw the same thing.
+ */
+
+/*!
+ * \brief Color of a brick by its hits left, the same in every backend.
+ * @param hits hits left
+ * @param rgb receives the color
+ * @return false if a brick with these hits isn't drawn
+ */
+inline bool brickColor(int hits, float rgb[3]) {
+    if (hits == 3) {
+        rgb[0] = 181/255.0f;
+        rgb[1] = 250/255.0f;
+        rgb[2] = 255/255.0f;
+    } else if (hits == 2) {
+        rgb[0] = 255.0f/255.0f;
+        rgb[1] = 249/255.0f;
+        rgb[2] = 181/255.0f;
+    } else if (hits == 1) {
+        rgb[0] = 1.0f;
+        rgb[1] = 1.0f;
+        rgb[2] = 1.0f;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/*!
+ * \brief Draw an entity with the canvas.
+ *
+ * Bricks are colored by their hits left, broken bricks aren't drawn.
+ * @param canvas render backend
+ * @param store entity data
+ * @param id entity index
+ * @param alpha interpolation factor between the previous and current position
+ */
+template<typename Canvas>
+void drawEntityShape(Canvas &canvas, const EntityStore &store, int id, float alpha) {
+    // bricks never move, so they don't keep a previous position
+    Vector3D pos = store.pos[id];
+    if (store.typeId[id] != 2) {
+        const Vector3D &prev = store.p_pos[id];
+        pos = prev + (pos - prev) * alpha;
+    }
+
+    if (store.shapeId[id] == 0) { // brick
+        if (store.typeId[id] == 2) {
+            float rgb[3];
+            if (!brickColor(store.hits[id], rgb)) {
+                return;
+            }
+            canvas.setColor(rgb[0], rgb[1], rgb[2]);
+        } else {
+            canvas.setColor(1.0f, 1.0f, 1.0f);
+        }
+
+        canvas.drawRect(pos.x, pos.y, store.width[id], store.height[id]);
+    } else {
+        canvas.setColor(1.0f, 1.0f, 1.0f);
+        canvas.drawCircle(pos.x, pos.y, store.radius[id]);
+    }
+}
+
+/*!
+ * \brief Draw every entity of a world.
+ * @param canvas render backend
+ * @param world world to draw
+ * @param alpha interpolation factor between the previous and current position
+ */
+template<typename Canvas>
+void drawWorldEntities(Canvas &canvas, const World &world, float alpha) {
+    for (int i = 0; i < world.entities.size(); ++i) {
+        drawEntityShape(canvas, world.entities, i, alpha);
+    }
+}
+
+/*!
+ * \brief Draw a string as one textured quad per glyph of the font atlas.
+ *
+ * The canvas has to sample the atlas of the font, the text is drawn in white.
+ * The glyphs have to be rasterized already, see FontAtlas::require.
+ * @param canvas render backend
+ * @param font rasterized glyphs
+ * @param text UTF-8 text to draw
+ * @param pos position of the baseline
+ * @param scale scale of the glyphs
+ * @param alignment 0 left, 1 center, 2 right of pos
+ */
+template<typename Canvas>
+void drawTextQuads(Canvas &canvas, const FontAtlas &font, const std::string &text, const Vector3D &pos, float scale,
+                   int alignment) {
+    canvas.setColor(1.0f, 1.0f, 1.0f);
+    layoutGlyphs(font, text, pos, scale, alignment, [&canvas](const GlyphQuad &q) {
+        canvas.drawQuad(q.left, q.bottom, q.right, q.top, q.u0, q.v0, q.u1, q.v1);
+    });
+}
+
+#endif //MONOREPO_JSTRACESKI_SCENEDRAW_H
@@ -0,0 +1,152 @@
+//
+// Created by jibbo on 4/3/21.
+//
+
+#ifndef MONOREPO_JSTRACESKI_SOFTRASTER_H
+#define MONOREPO_JSTRACESKI_SOFTRASTER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <FontAtlas.h>
+
+/*!
+ * \brief CPU rasterizer drawing the scene into a grayscale or RGBA byte buffer.
+ *
+ * A Canvas for SceneDraw.h, so it draws what the window draws without a GPU or a display:
+ * pixel observations for training and frames for golden image checks.
+ * Shapes are given in screen pixels with y pointing up, like SpriteBatch, and scaled down to the buffer size.
+ * A pixel is covered when its center is inside the shape, every shape row is a span filled with SIMD stores.
+ * Glyph quads sample the coverage of the font atlas set with setFont and blend it over the buffer.
+ *
+ * The buffer is either owned (init) or caller memory (setTarget), the latter costs no allocation,
+ * so a raster can be set up on the stack for every frame of every environment.
+ */
+class SoftRaster {
+private:
+    std::vector<uint8_t> storage;   /**<  owned pixels, empty when drawing into caller memory */
+    uint8_t *pixels = nullptr;      /**<  first byte of the top row */
+    int w = 0;                      /**<  buffer width in pixels */
+    int h = 0;                      /**<  buffer height in pixels */
+    int c = 1;                      /**<  bytes per pixel, 1 for gray, 4 for RGBA */
+
+    float xScale = 1;               /**<  screen to buffer scale on x */
+    float yScale = 1;               /**<  screen to buffer scale on y */
+    float screenTop = 0;            /**<  screen height, rows are counted down from it */
+
+    uint8_t color[4] = {255, 255, 255, 255};    /**<  current color, RGBA or gray in color[0] */
+    float alpha = 1;                            /**<  current opacity */
+    const FontAtlas *font = nullptr;            /**<  atlas sampled by drawQuad, nullptr for solid quads */
+
+    /*!
+     * Fill columns [x0, x1) of a row with the current color.
+     */
+    void fillSpan(int row, int x0, int x1);
+
+    /*!
+     * Blend the current color over a pixel.
+     * @param p first byte of the pixel
+     * @param a opacity, 0 to 255
+     */
+    void blend(uint8_t *p, int a);
+
+public:
+    SoftRaster() = default;
+
+    /*!
+     * \brief Allocate an owned buffer.
+     * @param width buffer width in pixels
+     * @param height buffer height in pixels
+     * @param channels 1 for grayscale, 4 for RGBA
+     * @param screenWidth width of the drawn screen area, scaled to the buffer width
+     * @param screenHeight height of the drawn screen area, scaled to the buffer height
+     * @return false if the sizes or channel count are invalid, true otherwise
+     */
+    bool init(int width, int height, int channels, int screenWidth, int screenHeight);
+
+    /*!
+     * \brief Draw into caller memory of width * height * channels bytes, rows top to bottom.
+     *
+     * Same parameters as init, the memory has to stay valid while drawing.
+     * @return false if the sizes or channel count are invalid, true otherwise
+     */
+    bool setTarget(uint8_t *target, int width, int height, int channels, int screenWidth, int screenHeight);
+
+    /*!
+     * \brief Fill the whole buffer.
+     */
+    void clear(float r, float g, float b);
+
+    /*!
+     * \brief Set the color of the following shapes, grayscale buffers store its luma.
+     */
+    void setColor(float r, float g, float b, float a = 1.0f);
+
+    /*!
+     * \brief Set the atlas sampled by drawQuad.
+     * @param atlas font atlas, nullptr to draw quads as solid rectangles
+     */
+    void setFont(const FontAtlas *atlas) {
+        font = atlas;
+    }
+
+    /*!
+     * \brief Draw an axis aligned rectangle.
+     * @param x center x in screen pixels
+     * @param y center y in screen pixels
+     * @param width width in screen pixels
+     * @param height height in screen pixels
+     */
+    void drawRect(float x, float y, float width, float height);
+
+    /*!
+     * \brief Draw a circle, an ellipse if the buffer isn't scaled the same on both axes.
+     * @param x center x in screen pixels
+     * @param y center y in screen pixels
+     * @param radius radius in screen pixels
+     */
+    void drawCircle(float x, float y, float radius);
+
+    /*!
+     * \brief Draw a quad textured with the font atlas.
+     *
+     * Distance field atlases are thresholded at the outline with about one pixel of antialiasing.
+     * @param left left edge in screen pixels
+     * @param bottom bottom edge in screen pixels
+     * @param right right edge in screen pixels
+     * @param top top edge in screen pixels
+     * @param u0 left texture coordinate
+     * @param v0 top texture coordinate
+     * @param u1 right texture coordinate
+     * @param v1 bottom texture coordinate
+     */
+    void drawQuad(float left, float bottom, float right, float top, float u0, float v0, float u1, float v1);
+
+    /*!
+     * \brief Write the buffer as a binary PGM (gray) or PPM (RGBA without alpha) image.
+     * @param path output path
+     * @return false if the file couldn't be written, true otherwise
+     */
+    bool save(const std::string &path) const;
+
+    int width() const {
+        return w;
+    }
+
+    int height() const {
+        return h;
+    }
+
+    int channels() const {
+        return c;
+    }
+
+    /*!
+     * \brief Pixels, rows top to bottom, width * channels bytes each.
+     */
+    const uint8_t *data() const {
+        return pixels;
+    }
+};
+
+#endif //MONOREPO_JSTRACESKI_SOFTRASTER_H
@@ -0,0 +1,152 @@
+//
+// Created by jibbo on 3/20/21.
+//
+
+#ifndef MONOREPO_JSTRACESKI_SPRITEBATCH_H
+#define MONOREPO_JSTRACESKI_SPRITEBATCH_H
+
+#include <LOpenGL.h>
+#include <TinyMath.hpp>
+#include <vector>
+
+/*!
+ * \brief Vertex layout of the sprite batch.
+ */
+struct SpriteVertex {
+    float x, y;         /**<  position in pixels */
+    float u, v;         /**<  texture coordinates, untextured circles use them for the offset from the center */
+    float r, g, b, a;   /**<  color */
+};
+
+/*!
+ * \brief Collects the quads and circles of a frame into one streamed vertex buffer.
+ *
+ * Shapes are converted to triangles on the CPU in pixel coordinates and drawn with a single glDrawArrays per flush,
+ * so the number of draw calls doesn't grow with the number of entities. The projection from pixels to the screen
+ * happens in the vertex shader. Textured quads (text) share the buffer, the batch only flushes when the bound
+ * texture changes.
+ * A circle is a single quad like a rectangle, the fragment shader discards the corners, so thousands of
+ * balls cost two triangles each instead of a triangle fan.
+ */
+class SpriteBatch {
+private:
+    std::vector<SpriteVertex> vertices;     /**<  vertices queued since the last flush */
+
+    GLuint program = 0;     /**<  shader program used to draw */
+    GLuint vao = 0;         /**<  vertex array object */
+    GLuint vbo = 0;         /**<  streamed vertex buffer */
+    GLint posLoc = -1;      /**<  position attribute location */
+    GLint colorLoc = -1;    /**<  color attribute location */
+    GLint uvLoc = -1;       /**<  texture coordinate attribute location */
+    GLint texturedLoc = -1; /**<  location of the uniform switching texture sampling on */
+    GLint distanceLoc = -1; /**<  location of the uniform marking the texture as a distance field */
+    GLint projectionLoc = -1;   /**<  location of the pixel to device projection uniform */
+
+    GLuint texture = 0;     /**<  texture of the queued vertices, 0 for plain colored shapes */
+    bool distanceField = false; /**<  the texture holds distance fields instead of coverage */
+
+    float color[4] = {1.0f, 1.0f, 1.0f, 1.0f}; /**<  current color */
+
+    /*!
+     * Queue a single vertex in pixel coordinates with the current color.
+     */
+    void vertex(float x, float y, float u = 0, float v = 0) {
+        SpriteVertex sv = {x, y, u, v, color[0], color[1], color[2], color[3]};
+        vertices.push_back(sv);
+    }
+
+public:
+    int drawCalls = 0;  /**<  draw calls issued since begin */
+
+    /*!
+     * \brief Create the GL buffers.
+     *
+     * The program needs vec2 LVertexPos2D, vec2 LTexCoord and vec4 LVertexColor attributes,
+     * a mat3 LProjection uniform mapping pixels to device coordinates and a bool LTextured uniform
+     * enabling the texture lookup. Untextured fragments with texture coordinates
+     * outside the unit circle have to be discarded for circles to be round.
+     * An optional bool LDistanceField uniform is set for textures holding distance fields, see FontAtlas.
+     * @param programId linked shader program
+     * @param width screen width in pixels
+     * @param height screen height in pixels
+     * @return false if the program is missing the attributes, true otherwise
+     */
+    bool init(GLuint programId, int width, int height);
+
+    /*!
+     * \brief Change the size of the screen the pixel coordinates refer to.
+     *
+     * Only updates the projection uniform, the queued vertices stay in pixels.
+     * @param width screen width in pixels
+     * @param height screen height in pixels
+     */
+    void setScreenSize(int width, int height);
+
+    /*!
+     * \brief Start a new frame.
+     */
+    void begin();
+
+    /*!
+     * \brief Set the color of the following shapes.
+     */
+    void setColor(float r, float g, float b, float a = 1.0f) {
+        color[0] = r;
+        color[1] = g;
+        color[2] = b;
+        color[3] = a;
+    }
+
+    /*!
+     * \brief Set the texture of the following textured quads.
+     *
+     * Flushes the queued vertices if the texture changes.
+     * @param tex GL texture, 0 for plain colored shapes
+     * @param distance the texture holds distance fields that are thresholded at 0.5
+     */
+    void setTexture(GLuint tex, bool distance = false);
+
+    /*!
+     * \brief Queue an axis aligned rectangle.
+     * @param x center x in pixels
+     * @param y center y in pixels
+     * @param w width in pixels
+     * @param h height in pixels
+     */
+    void drawRect(float x, float y, float w, float h);
+
+    /*!
+     * \brief Queue a circle.
+     *
+     * Queued as the bounding square with texture coordinates from -1 to 1 across it.
+     * @param x center x in pixels
+     * @param y center y in pixels
+     * @param radius radius in pixels
+     */
+    void drawCircle(float x, float y, float radius);
+
+    /*!
+     * \brief Queue a textured quad.
+     * @param left left edge in pixels
+     * @param bottom bottom edge in pixels
+     * @param right right edge in pixels
+     * @param top top edge in pixels
+     * @param u0 left texture coordinate
+     * @param v0 top texture coordinate
+     * @param u1 right texture coordinate
+     * @param v1 bottom texture coordinate
+     */
+    void drawQuad(float left, float bottom, float right, float top, float u0, float v0, float u1, float v1);
+
+    /*!
+     * \brief Upload the queued vertices and draw them.
+     */
+    void flush();
+
+    /*!
+     * \brief Delete the GL buffers.
+     */
+    void shutDown();
+};
+
+#endif //MONOREPO_JSTRACESKI_SPRITEBATCH_H
@@ -0,0 +1,86 @@
+//
+// Created by jibbo on 3/23/21.
+//
+
+#ifndef MONOREPO_JSTRACESKI_SPSCQUEUE_H
+#define MONOREPO_JSTRACESKI_SPSCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+
+/*!
+ * \brief Fixed size single producer, single consumer lock free ring buffer.
+ *
+ * One thread may push and one other thread may pop at the same time without locks.
+ * Neither side ever waits on the other, push fails when the buffer is full and pop fails when it's empty.
+ * An element is only published after it is fully written, so the consumer never sees a partial update.
+ *
+ * @tparam T element type, copied in and out
+ * @tparam N capacity, must be a power of two
+ */
+template<typename T, size_t N>
+class SpscQueue {
+private:
+    static_assert(N > 0 && (N & (N - 1)) == 0, "SpscQueue capacity must be a power of two");
+
+    static const size_t CACHE_LINE = 64;    /**<  keeps the indices on separate lines so the threads don't share one */
+
+    T items[N];                                         /**<  ring storage */
+    alignas(CACHE_LINE) std::atomic<size_t> head{0};    /**<  next slot to read, written by the consumer only */
+    alignas(CACHE_LINE) std::atomic<size_t> tail{0};    /**<  next slot to write, written by the producer only */
+
+public:
+    /*!
+     * \brief Add an element, producer thread only.
+     * @param item element to copy in
+     * @return false if the queue is full and the element was dropped, true otherwise
+     */
+    bool push(const T &item) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == N) {
+            return false;
+        }
+
+        items[t & (N - 1)] = item;
+        // release publishes the element write before the new tail
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    /*!
+     * \brief Take the oldest element, consumer thread only.
+     * @param item receives the element
+     * @return false if the queue is empty, true otherwise
+     */
+    bool pop(T &item) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+
+        item = items[h & (N - 1)];
+        // release hands the slot back to the producer only after it was read
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    /*!
+     * \brief Number of queued elements.
+     *
+     * Only a snapshot when called while the other thread is active.
+     */
+    size_t size() const {
+        // head first, the tail read afterwards can only be the same or further ahead
+        size_t h = head.load(std::memory_order_acquire);
+        return tail.load(std::memory_order_acquire) - h;
+    }
+
+    /*!
+     * \brief Number of elements the queue can hold.
+     */
+    static constexpr size_t capacity() {
+        return N;
+    }
+};
+
+#endif //MONOREPO_JSTRACESKI_SPSCQUEUE_H
@@ -0,0 +1,143 @@
+//
+// Created by jibbo on 3/31/21.
+//
+
+#ifndef MONOREPO_JSTRACESKI_STATEHASH_H
+#define MONOREPO_JSTRACESKI_STATEHASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+struct World;
+
+/*!
+ * \brief Parts of the simulation state hashed separately, so a mismatch can name what diverged.
+ */
+enum StateField {
+    STATE_POS = 0,      /**<  entity positions */
+    STATE_VEL,          /**<  entity velocities */
+    STATE_HITS,         /**<  entity hit counts */
+    STATE_ACTIVE,       /**<  entity active flags */
+    STATE_SCORE,        /**<  score */
+    STATE_LIVES,        /**<  player lives */
+    STATE_LEVEL,        /**<  level id and bricks left */
+    STATE_FLOW,         /**<  pause timer, pause reason, game over and ball captured flags */
+    STATE_FIELD_COUNT
+};
+
+/*!
+ * \brief Hash of every StateField of a world after a tick.
+ */
+struct StateHashes {
+    uint64_t fields[STATE_FIELD_COUNT]; /**<  hash of each field */
+
+    /*!
+     * \brief All fields combined into one hash.
+     */
+    uint64_t combined() const;
+};
+
+/*!
+ * \brief Name of a state field, used in divergence reports.
+ * @param field StateField
+ */
+const char *stateFieldName(int field);
+
+/*!
+ * \brief Hash every field of the simulation state of a world.
+ *
+ * Values are hashed bit for bit, so two worlds with equal hashes stepped through the same inputs stay equal.
+ * @param world world to hash
+ * @param out receives the hashes
+ */
+void hashWorldFields(const World &world, StateHashes &out);
+
+/*!
+ * \brief Hash of the simulation state of a world.
+ *
+ * Covers every entity position, velocity, hit count and active flag and the score, lives, level and pause state.
+ * @param world world to hash
+ * @return 64 bit hash, hashWorldFields combined
+ */
+uint64_t hashWorldState(const World &world);
+
+/*!
+ * \brief XXH64 hash of a byte range.
+ *
+ * Reads 32 bytes per round, so hashing the state of a level is a fraction of the cost of stepping it.
+ * Multi byte values are read in native byte order.
+ * @param data bytes to hash
+ * @param size number of bytes
+ * @param seed hash seed, chaining the previous hash in hashes several ranges
+ * @return 64 bit hash
+ */
+uint64_t hashBytes(const void *data, size_t size, uint64_t seed = 0);
+
+/*!
+ * \brief Debug stream of the per tick state hashes.
+ *
+ * Either writes the hashes of every tick to a log file, or reads a reference log and compares every tick
+ * against it, reporting the first tick and the fields that differ.
+ */
+class StateHashLog {
+private:
+    FILE *file = nullptr;       /**<  open log */
+    bool writing = false;       /**<  log mode, false for compare mode */
+    long long tick = 0;         /**<  next tick index */
+    long long diverged = -1;    /**<  first tick that differed from the reference, -1 if none */
+
+public:
+    StateHashLog() = default;
+    StateHashLog(StateHashLog const&) = delete;     /**<  owns the file */
+    void operator=(StateHashLog const&) = delete;   /**<  Don't allow assignment. */
+
+    ~StateHashLog() {
+        close();
+    }
+
+    /*!
+     * \brief Start logging the hash stream to a file.
+     * @param path output path
+     * @return false if the file can't be written, true otherwise
+     */
+    bool record(const std::string &path);
+
+    /*!
+     * \brief Start comparing the hash stream against a reference log.
+     * @param path log written by record
+     * @return false if the file can't be read or isn't a hash log, true otherwise
+     */
+    bool compare(const std::string &path);
+
+    /*!
+     * \brief Log or compare the state after a tick.
+     *
+     * Prints the first divergent tick with the fields that differ, later ticks are not reported again.
+     * @param world world after the tick
+     * @return false once the stream diverged from the reference or the reference ended, true otherwise
+     */
+    bool tickDone(const World &world);
+
+    /*!
+     * \brief Is a log open.
+     */
+    bool active() const {
+        return file != nullptr;
+    }
+
+    /*!
+     * \brief First tick that differed from the reference, -1 if none did.
+     */
+    long long divergedTick() const {
+        return diverged;
+    }
+
+    /*!
+     * \brief Flush and close the log.
+     */
+    void close();
+};
+
+#endif //MONOREPO_JSTRACESKI_STATEHASH_H
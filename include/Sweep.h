@@ -0,0 +1,158 @@
+//
+// Created by jibbo on 3/27/21.
+//
+
+#ifndef MONOREPO_JSTRACESKI_SWEEP_H
+#define MONOREPO_JSTRACESKI_SWEEP_H
+
+#include <TinyMath.hpp>
+#include <cmath>
+
+/*!
+ * \brief First contact of a moving circle.
+ */
+struct SweepHit {
+    float t = 1;                            /**<  fraction of the movement before the contact, 0 if the shapes already overlap */
+    Vector3D normal = Vector3D(0, 0, 0);    /**<  contact normal pointing from the obstacle towards the circle */
+    Vector3D point = Vector3D(0, 0, 0);     /**<  closest point on the obstacle at the contact */
+};
+
+/*!
+ * \brief Find the time of impact of a circle moving against an axis aligned rectangle.
+ *
+ * The circle center is traced against the rectangle grown by the radius: the slab test finds the face,
+ * contacts outside the face span are retested against the circle around the corner.
+ * Circles that already overlap the rectangle, or touch it while moving into it, hit at t = 0 with the normal
+ * pushing them out.
+ *
+ * @param start circle center at the start of the movement
+ * @param delta circle movement
+ * @param radius circle radius
+ * @param center rectangle center
+ * @param halfWidth half of the rectangle width
+ * @param halfHeight half of the rectangle height
+ * @param hit receives the contact, only written when there is one
+ * @return true if the circle touches the rectangle during the movement
+ */
+inline bool SweepCircleRect(const Vector3D &start, const Vector3D &delta, float radius,
+                            const Vector3D &center, float halfWidth, float halfHeight, SweepHit &hit) {
+    float minX = center.x - halfWidth;
+    float maxX = center.x + halfWidth;
+    float minY = center.y - halfHeight;
+    float maxY = center.y + halfHeight;
+
+    // already overlapping, a circle exactly touching only hits when it moves into the rectangle,
+    // sliding along or leaving the surface is no contact
+    float closestX = fminf(fmaxf(start.x, minX), maxX);
+    float closestY = fminf(fmaxf(start.y, minY), maxY);
+    float dx = start.x - closestX;
+    float dy = start.y - closestY;
+    float d2 = dx * dx + dy * dy;
+    bool touchingInward = d2 == radius * radius && dx * delta.x + dy * delta.y < 0;
+    if (d2 < radius * radius || touchingInward) {
+        hit.t = 0;
+        hit.point = Vector3D(closestX, closestY, 0);
+        if (dx != 0 || dy != 0) {
+            hit.normal = Normalize(Vector3D(dx, dy, 0));
+        } else {
+            // center inside the rectangle, leave through the closest face
+            float left = start.x - minX;
+            float right = maxX - start.x;
+            float bottom = start.y - minY;
+            float top = maxY - start.y;
+            float m = fminf(fminf(left, right), fminf(bottom, top));
+            if (m == left) {
+                hit.normal = Vector3D(-1, 0, 0);
+                hit.point = Vector3D(minX, start.y, 0);
+            } else if (m == right) {
+                hit.normal = Vector3D(1, 0, 0);
+                hit.point = Vector3D(maxX, start.y, 0);
+            } else if (m == bottom) {
+                hit.normal = Vector3D(0, -1, 0);
+                hit.point = Vector3D(start.x, minY, 0);
+            } else {
+                hit.normal = Vector3D(0, 1, 0);
+                hit.point = Vector3D(start.x, maxY, 0);
+            }
+        }
+        return true;
+    }
+
+    // slab test against the rectangle grown by the radius
+    float tEnter = 0;
+    float tExit = 1;
+    Vector3D normal = Vector3D(0, 0, 0);
+
+    const float lo[2] = {minX - radius, minY - radius};
+    const float hi[2] = {maxX + radius, maxY + radius};
+    const float p[2] = {start.x, start.y};
+    const float d[2] = {delta.x, delta.y};
+    for (int axis = 0; axis < 2; ++axis) {
+        if (d[axis] == 0) {
+            if (p[axis] < lo[axis] || p[axis] > hi[axis]) {
+                return false;
+            }
+            continue;
+        }
+
+        float inv = 1.0f / d[axis];
+        float t0 = (lo[axis] - p[axis]) * inv;
+        float t1 = (hi[axis] - p[axis]) * inv;
+        float side = -1;
+        if (t0 > t1) {
+            float tmp = t0;
+            t0 = t1;
+            t1 = tmp;
+            side = 1;
+        }
+
+        if (t0 > tEnter) {
+            tEnter = t0;
+            normal = axis == 0 ? Vector3D(side, 0, 0) : Vector3D(0, side, 0);
+        }
+        if (t1 < tExit) {
+            tExit = t1;
+        }
+        if (tEnter > tExit) {
+            return false;
+        }
+    }
+
+    Vector3D contact = start + delta * tEnter;
+    bool inSpanX = contact.x >= minX && contact.x <= maxX;
+    bool inSpanY = contact.y >= minY && contact.y <= maxY;
+    if (inSpanX || inSpanY) {
+        // no slab was entered during the movement, the circle only rests on a face without moving into it
+        if (normal.x == 0 && normal.y == 0) {
+            return false;
+        }
+        hit.t = tEnter;
+        hit.normal = normal;
+        hit.point = Vector3D(fminf(fmaxf(contact.x, minX), maxX), fminf(fmaxf(contact.y, minY), maxY), 0);
+        return true;
+    }
+
+    // the grown rectangle has rounded corners, trace the center against the corner circle
+    Vector3D corner = Vector3D(contact.x < minX ? minX : maxX, contact.y < minY ? minY : maxY, 0);
+    Vector3D m = start - corner;
+    float a = Dot(delta, delta);
+    float b = Dot(m, delta);
+    float c = Dot(m, m) - radius * radius;
+    float disc = b * b - a * c;
+    if (a == 0 || disc < 0) {
+        return false;
+    }
+
+    // touching the corner at the start only counts when moving towards it
+    float t = (-b - sqrtf(disc)) / a;
+    if (t < 0 || t > 1 || (t == 0 && b >= 0)) {
+        return false;
+    }
+
+    hit.t = t;
+    hit.normal = Normalize(start + delta * t - corner);
+    hit.point = corner;
+    return true;
+}
+
+#endif //MONOREPO_JSTRACESKI_SWEEP_H
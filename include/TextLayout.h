@@ -0,0 +1,151 @@
+//
+// Created by jibbo on 4/7/21.
+//
+
+#ifndef MONOREPO_JSTRACESKI_TEXTLAYOUT_H
+#define MONOREPO_JSTRACESKI_TEXTLAYOUT_H
+
+#include <string>
+#include <vector>
+#include <FontAtlas.h>
+#include <TinyMath.hpp>
+
+/*!
+ * \brief Screen rectangle and atlas coordinates of one glyph of a string.
+ */
+struct GlyphQuad {
+    float left, bottom, right, top;     /**<  edges in pixels */
+    float u0, v0, u1, v1;               /**<  atlas coordinates, v0 is the top */
+};
+
+/*!
+ * \brief Place the glyphs of a string.
+ *
+ * Measures the string for the alignment, then hands the quad of every glyph to emit in order.
+ * Glyphs the atlas doesn't hold yet take no space, call FontAtlas::require for the text first.
+ * @param font rasterized glyphs
+ * @param text UTF-8 text to place
+ * @param pos position of the baseline
+ * @param scale scale of the glyphs
+ * @param alignment 0 left, 1 center, 2 right of pos
+ * @param emit called with every GlyphQuad
+ */
+template<typename Emit>
+void layoutGlyphs(const FontAtlas &font, const std::string &text, const Vector3D &pos, float scale, int alignment,
+                  Emit emit) {
+    float x = pos.x;
+    float y = pos.y;
+    float textShift = 0;
+    float textWidth = 0;
+
+    if (alignment > 0) {
+        for (size_t i = 0; i < text.size();) {
+            const Glyph &ch = font.glyph(nextCodepoint(text, i));
+            textWidth += (float) (ch.advance >> 6) * scale;
+        }
+        if (alignment == 1) {
+            textShift = (int) (-textWidth/2.0f);
+        } else {
+            textShift = (int) (-textWidth);
+        }
+    }
+
+    // MODIFIED from https://learnopengl.com/In-Practice/Text-Rendering
+    for (size_t i = 0; i < text.size();) {
+        const Glyph &ch = font.glyph(nextCodepoint(text, i));
+
+        float xpos = x + (float) ch.x * scale + textShift;
+        float ypos = y - (float) ((int) ch.height - ch.y) * scale;
+
+        float w = (float) ch.width * scale;
+        float h = (float) ch.height * scale;
+
+        GlyphQuad q = {xpos, ypos, xpos + w, ypos + h, ch.u0, ch.v0, ch.u1, ch.v1};
+        emit(q);
+
+        x += (float) (ch.advance >> 6) * scale; // bitshift by 6 to get value in pixels (2^6 = 64)
+    }
+}
+
+/*!
+ * \brief A string laid out once and drawn every frame.
+ *
+ * Keeps the glyph quads of the last string it was set to, keyed by the text, the number shown after it,
+ * position, scale and alignment. Setting the same values again only compares them, so a HUD that doesn't change
+ * does no string building, measuring or glyph lookups in a frame. The quads are also redone when the atlas grows,
+ * since that moves the texture coordinates of every glyph.
+ */
+class TextLayout {
+private:
+    std::vector<GlyphQuad> quads;       /**<  glyphs of the laid out string */
+
+    FontAtlas *font = nullptr;          /**<  atlas the quads point into */
+    int generation = -1;                /**<  atlas generation the quads were laid out with */
+    std::string label;                  /**<  text, without the number */
+    bool hasNumber = false;             /**<  a number follows the label */
+    int number = 0;                     /**<  number shown after the label */
+    Vector3D pos = Vector3D(0, 0, 0);   /**<  position of the baseline */
+    float scale = 0;                    /**<  scale of the glyphs */
+    int alignment = -1;                 /**<  0 left, 1 center, 2 right of pos */
+
+    /*!
+     * Lay the string out again, the key fields are already set.
+     */
+    void build();
+
+    /*!
+     * Rasterize the missing glyphs of the string and lay it out.
+     * @param text label and number put together
+     */
+    void place(const std::string &text);
+
+public:
+    int builds = 0;     /**<  times the quads were rebuilt */
+
+    /*!
+     * \brief Show a string.
+     * @param atlas font atlas, missing glyphs are rasterized into it, has to outlive the layout
+     * @param text UTF-8 text to show
+     * @param position position of the baseline
+     * @param size scale of the glyphs
+     * @param align 0 left, 1 center, 2 right of position
+     * @return true if the string had to be laid out again
+     */
+    bool set(FontAtlas &atlas, const std::string &text, const Vector3D &position, float size, int align);
+
+    /*!
+     * \brief Show a label followed by a space and a number, like "score 12".
+     *
+     * The string is only put together when the label or number changed.
+     * @param atlas font atlas, missing glyphs are rasterized into it, has to outlive the layout
+     * @param text UTF-8 label
+     * @param value number after the label
+     * @param position position of the baseline
+     * @param size scale of the glyphs
+     * @param align 0 left, 1 center, 2 right of position
+     * @return true if the string had to be laid out again
+     */
+    bool set(FontAtlas &atlas, const std::string &text, int value, const Vector3D &position, float size,
+             int align);
+
+    /*!
+     * \brief Lay the string out again if the atlas grew since it was set.
+     *
+     * Another string can need new glyphs after this one was set, call it right before drawing.
+     * @return true if the string had to be laid out again
+     */
+    bool refresh();
+
+    /*!
+     * \brief Queue the glyphs in white with a canvas sampling the atlas of the font, see SceneDraw.h.
+     */
+    template<typename Canvas>
+    void draw(Canvas &canvas) const {
+        canvas.setColor(1.0f, 1.0f, 1.0f);
+        for (const GlyphQuad &q : quads) {
+            canvas.drawQuad(q.left, q.bottom, q.right, q.top, q.u0, q.v0, q.u1, q.v1);
+        }
+    }
+};
+
+#endif //MONOREPO_JSTRACESKI_TEXTLAYOUT_H
@@ -0,0 +1,82 @@
+//
+// Created by jibbo on 3/28/21.
+//
+
+#ifndef MONOREPO_JSTRACESKI_THREADPOOL_H
+#define MONOREPO_JSTRACESKI_THREADPOOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*!
+ * \brief Fixed set of worker threads running index ranges.
+ *
+ * Built for running many independent worlds: the caller hands over a count and a function of an index,
+ * the workers pull chunks of indices from a shared counter until the range is done.
+ * Workers only touch the shared state once per chunk, so throughput scales with the thread count
+ * as long as the work items don't share data.
+ */
+class ThreadPool {
+private:
+    std::vector<std::thread> workers;   /**<  worker threads */
+
+    std::mutex mutex;                   /**<  guards every member below */
+    std::condition_variable wake;       /**<  signals workers that a job started or the pool stopped */
+    std::condition_variable finished;   /**<  signals the caller that the last chunk of the job completed */
+
+    std::function<void(int)> job;       /**<  function of the running job */
+    int count = 0;                      /**<  indices in the running job */
+    int next = 0;                       /**<  first index not handed out yet */
+    int chunk = 1;                      /**<  indices handed out at once */
+    int pending = 0;                    /**<  indices not finished yet */
+    unsigned long long generation = 0;  /**<  incremented for every job so sleeping workers notice new ones */
+    bool stopping = false;              /**<  set when the pool shuts down */
+
+    /*!
+     * Worker loop, runs chunks until the pool stops.
+     */
+    void work();
+
+    /*!
+     * Run chunks of the current job until none are left.
+     * @param lock held lock on mutex, released while running the job
+     */
+    void runChunks(std::unique_lock<std::mutex> &lock);
+
+public:
+    /*!
+     * \brief Start the workers.
+     * @param threads number of threads, 0 for one per hardware thread
+     */
+    explicit ThreadPool(int threads = 0);
+
+    ThreadPool(ThreadPool const&) = delete;         /**<  owns threads */
+    void operator=(ThreadPool const&) = delete;     /**<  Don't allow assignment. */
+
+    /*!
+     * \brief Stop and join the workers.
+     */
+    ~ThreadPool();
+
+    /*!
+     * \brief Number of worker threads.
+     */
+    int size() const {
+        return (int) workers.size();
+    }
+
+    /*!
+     * \brief Call fn(i) for every i in [0, n) on the workers and wait until all calls returned.
+     *
+     * The calling thread helps with the work. Not reentrant, fn must not call parallelFor on the same pool.
+     * @param n number of indices
+     * @param fn function of the index, called concurrently from several threads
+     * @param grain indices handed to a thread at once, 0 to pick one from n and the thread count
+     */
+    void parallelFor(int n, const std::function<void(int)> &fn, int grain = 0);
+};
+
+#endif //MONOREPO_JSTRACESKI_THREADPOOL_H
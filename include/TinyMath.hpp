@@ -2,6 +2,7 @@
 #define TINYMATH_H
 
 #include <cmath>
+#include <cstdio>
 
 // Forward references of each of the structs
 struct Vector3D;
@@ -299,4 +300,14 @@ inline Vector3D operator*(const Matrix3D &M, const Vector3D &v) {
 }
 
 
+// Orthographic projection as a 2D homogeneous transform
+// Maps points (x, y, 1) of the box from left/bottom to right/top onto -1..1 device coordinates.
+inline Matrix3D Orthographic2D(float left, float right, float bottom, float top) {
+    Matrix3D mat3D(2.0f / (right - left), 0, -(right + left) / (right - left),
+                   0, 2.0f / (top - bottom), -(top + bottom) / (top - bottom),
+                   0, 0, 1);
+    return mat3D;
+}
+
+
 #endif
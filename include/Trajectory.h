@@ -0,0 +1,98 @@
+//
+// Created by jibbo on 4/4/21.
+//
+
+#ifndef MONOREPO_JSTRACESKI_TRAJECTORY_H
+#define MONOREPO_JSTRACESKI_TRAJECTORY_H
+
+#include <cstdint>
+#include <World.h>
+
+/*!
+ * \brief Where and when the ball comes down to a height.
+ */
+struct TrajectoryPrediction {
+    bool reached = false;                   /**<  the ball gets to the height within the bounce limit */
+    Vector3D point = Vector3D(0, 0, 0);     /**<  ball center when it gets there */
+    Vector3D velocity = Vector3D(0, 0, 0);  /**<  ball velocity there, pixels per base tick */
+    float ticks = 0;                        /**<  ticks until then, fractional */
+    int bounces = 0;                        /**<  wall and brick reflections on the way */
+    int brickHits = 0;                      /**<  brick contacts among them */
+};
+
+/*!
+ * \brief Follow a ball analytically until it moves down through a height.
+ *
+ * The ball travels in straight lines between contacts, so instead of stepping ticks the path is cut at the next
+ * wall and the next brick: walls are solved directly, bricks by marching the segment through the brick grid in
+ * steps of one row pitch and sweeping the ball against the bricks of the cells each step covers.
+ * Contacts reflect the velocity the way World::sweep does and use up brick hits, a brick broken on the way is
+ * passed through afterwards. The paddle isn't considered, it is what the prediction is for.
+ *
+ * @param world world with the bricks and config, the ball entity isn't read
+ * @param pos ball center
+ * @param vel ball velocity, pixels per base tick
+ * @param radius ball radius
+ * @param targetY height of the ball center to predict
+ * @param maxBounces reflections followed before giving up
+ * @return prediction, reached is false if the ball doesn't get down to targetY
+ */
+TrajectoryPrediction predictBallPath(const World &world, const Vector3D &pos, const Vector3D &vel, float radius,
+                                     float targetY, int maxBounces = 32);
+
+/*!
+ * \brief Predict where the ball of a world comes down to the top of the paddle.
+ * @param world world to predict
+ * @param maxBounces reflections followed before giving up
+ * @return prediction of the ball center at the height it touches the paddle top
+ */
+TrajectoryPrediction predictBall(const World &world, int maxBounces = 32);
+
+/*!
+ * \brief Paddle controller that meets the ball where the predictor says it comes down.
+ *
+ * Produces the same WorldInput as the a/d/space keys, so it drives a World, the window game or a recording alike.
+ * The paddle accelerates towards the predicted point and lets drag stop it there.
+ * Where the ball lands on the paddle sets the return angle, so the autopilot tries a few spots, predicts
+ * each return and takes the one hitting the most bricks. Returns too flat to leave the paddle are never picked,
+ * ties go to a different spot every time so the ball doesn't settle into a loop.
+ * The prediction is only redone when the ball velocity changes, between contacts the path is known.
+ */
+class Autopilot {
+private:
+    static const int AIM_SPOTS = 9;         /**<  contact spots tried across the paddle */
+
+    uint32_t rng;                           /**<  state of the tie breaking generator */
+    int firstSpot = 0;                      /**<  spot checked first, wins ties */
+    float aim = 0;                          /**<  offset of the contact from the paddle center in pixels */
+    TrajectoryPrediction path;              /**<  current prediction */
+    Vector3D pathVelocity = Vector3D(0, 0, 0);  /**<  ball velocity the prediction was made for */
+    bool havePath = false;                  /**<  path is valid for pathVelocity */
+
+    /*!
+     * Pick the contact offset for the ball coming down along path.
+     * @param world world to predict
+     */
+    void chooseAim(const World &world);
+
+public:
+    /*!
+     * @param seed aim generator seed, the same seed plays the same game
+     */
+    explicit Autopilot(uint32_t seed = 1);
+
+    /*!
+     * \brief Input for the next tick.
+     * @param world world about to be stepped
+     */
+    WorldInput next(const World &world);
+
+    /*!
+     * \brief Last prediction, reached is false while the ball sits on the paddle or is below it.
+     */
+    const TrajectoryPrediction &prediction() const {
+        return path;
+    }
+};
+
+#endif //MONOREPO_JSTRACESKI_TRAJECTORY_H
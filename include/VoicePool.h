@@ -0,0 +1,91 @@
+//
+// Created by jibbo on 3/24/21.
+//
+
+#ifndef MONOREPO_JSTRACESKI_VOICEPOOL_H
+#define MONOREPO_JSTRACESKI_VOICEPOOL_H
+
+#include <LOpenGL.h>
+#include <AudioMixer.h>
+
+struct Clip;
+
+/*!
+ * \brief A single playing instance of a clip.
+ *
+ * Voices only point at the clip data, many voices can play the same clip at different positions.
+ */
+struct Voice {
+    Clip *clip = nullptr;           /**<  clip being played */
+    Uint32 trackPos = 0;            /**<  track position in bytes */
+    unsigned long long started = 0; /**<  trigger number the voice was started with, used to find the oldest voice */
+    bool active = false;            /**<  is the voice playing or not */
+};
+
+/*!
+ * \brief Fixed set of voices mixed by the audio callback.
+ *
+ * Triggering a clip claims a free voice so rapid hits layer instead of restarting each other.
+ * When every voice is busy the oldest one is stolen, looping voices (music) are only stolen
+ * if nothing else is playing. The voices are preallocated, playing a sound never allocates.
+ * Audio thread only.
+ */
+class VoicePool {
+public:
+    static const int MAX_VOICES = 64;  /**<  number of sounds that can play at once */
+
+private:
+    Voice voices[MAX_VOICES];           /**<  voice storage */
+    AudioMixer mixer;                   /**<  sums the voices of the current buffer */
+    unsigned long long triggers = 0;    /**<  number of play calls so far */
+
+    /*!
+     * Find the voice a new trigger should use.
+     * @return a free voice if there is one, the oldest voice otherwise
+     */
+    Voice &claim();
+
+public:
+    /*!
+     * \brief Allocate the mix buffer before the audio device starts.
+     * @param samples samples per callback buffer, all channels
+     */
+    void reserve(size_t samples) {
+        mixer.reserve(samples);
+    }
+
+    /*!
+     * \brief Start a clip on a new voice.
+     * @param clip clip to play
+     */
+    void play(Clip *clip);
+
+    /*!
+     * \brief Stop every voice playing a clip.
+     * @param clip clip to stop
+     */
+    void stop(Clip *clip);
+
+    /*!
+     * \brief Stop every voice.
+     */
+    void stopAll();
+
+    /*!
+     * \brief Number of voices currently playing.
+     */
+    int activeCount() const;
+
+    /*!
+     * \brief Mix all active voices into the stream.
+     *
+     * Clips and the stream are signed 16 bit samples. Voices are summed without clipping and the
+     * sum is saturated once when it's written out.
+     * Voices of looping clips wrap to the start, the others are released when they reach the end.
+     * @param stream audio buffer, overwritten with the mix (silence if no voice is active)
+     * @param len length of the buffer in bytes
+     */
+    void mix(Uint8 *stream, Uint32 len);
+};
+
+#endif //MONOREPO_JSTRACESKI_VOICEPOOL_H
@@ -0,0 +1,263 @@
+//
+// Created by jibbo on 3/14/21.
+//
+
+#ifndef MONOREPO_JSTRACESKI_WORLD_H
+#define MONOREPO_JSTRACESKI_WORLD_H
+
+#include <string>
+#include <vector>
+#include <EntityStore.h>
+#include <BrickGrid.h>
+#include <Sweep.h>
+#include <LevelFile.h>
+
+/*!
+ * \brief Tunable simulation values.
+ *
+ * Shared by the window game and headless runs, defaults match the original game.
+ * Velocities are in pixels per base tick, so changing tickRate changes the step size but not the gameplay speed.
+ */
+struct WorldConfig {
+    int screenWidth = 1080;     /**<  play field width */
+    int screenHeight = 720;     /**<  play field height */
+
+    int brickTopOffset = 80;    /**<  offset between the top of the bricks and the top of the play field */
+    int brickHeight = 20;       /**<  height of a brick */
+    int brickSpacing = 5;       /**<  space between bricks */
+
+    float paddleSpeed = 0.8f;   /**<  paddle speed added to the velocity of the paddle every base tick */
+    float maxSpeed = 10.0f;     /**<  ball and paddle max speed in pixels per base tick */
+    int maxBounces = 4;         /**<  contacts resolved per ball per tick, the rest of the movement is dropped */
+
+    int baseTickRate = 60;      /**<  tick rate the speed, drag and acceleration values are given in */
+    int tickRate = 60;          /**<  simulation ticks per second */
+    float pauseDelay = 3;       /**<  seconds the world stays paused after a level change */
+    int lives = 3;              /**<  player lives at the start of a level */
+    int multiBall = 0;          /**<  extra balls split off the ball on every serve, 0 plays with a single ball */
+
+    /*!
+     * \brief Width of the bricks in a row, bricks stretch to fill the play field.
+     * @param cols number of cells in the row
+     */
+    float brickWidth(int cols) const {
+        float brickSpace = (float) screenWidth - (float) (cols + 1) * (float) brickSpacing;
+        return brickSpace / (float) cols;
+    }
+
+    /*!
+     * \brief Center x of a brick.
+     * @param col cell index in the row
+     * @param width brick width of the row
+     */
+    float brickX(int col, float width) const {
+        return (float) (brickSpacing * (col + 1)) + width / 2.0f + width * (float) col;
+    }
+
+    /*!
+     * \brief Center y of the bricks in a row.
+     * @param row row index, 0 is the top row
+     */
+    float brickY(int row) const {
+        float fromTop = (float) brickTopOffset
+                + (float) brickHeight / 2.0f
+                + (float) (brickSpacing * (row + 1))
+                + (float) (brickHeight * row);
+        return (float) screenHeight - fromTop;
+    }
+};
+
+/*!
+ * \brief Player input for a single tick.
+ *
+ * Plain key state so the world can be driven by a keyboard, a bot or a recording.
+ */
+struct WorldInput {
+    bool left = false;      /**<  accelerate the paddle to the left */
+    bool right = false;     /**<  accelerate the paddle to the right */
+    bool shoot = false;     /**<  release the ball from the paddle */
+};
+
+/*!
+ * \brief Things that happened during the last tick.
+ *
+ * Used by the front end to play sounds without the simulation knowing about audio.
+ */
+struct WorldEvents {
+    int hits = 0;               /**<  number of ball collisions with the paddle or bricks */
+    bool levelChanged = false;  /**<  a level was won, lost or restarted */
+    std::vector<int> bricksHit; /**<  entity index of every brick hit, once per contact */
+
+    /*!
+     * \brief Forget the events of the last tick, keeps the capacity of bricksHit.
+     */
+    void clear() {
+        hits = 0;
+        levelChanged = false;
+        bricksHit.clear();
+    }
+};
+
+/*!
+ * \brief Reason for the pause after a level change.
+ */
+enum PauseReason {
+    PAUSE_NONE = 0,     /**<  not paused */
+    PAUSE_NEXT_LEVEL,   /**<  level cleared, next level loaded */
+    PAUSE_WIN,          /**<  last level cleared */
+    PAUSE_LOSE          /**<  out of lives, level restarted */
+};
+
+/*!
+ * \brief Headless game simulation.
+ *
+ * Holds the entities and rules of a single game and steps them from plain input structs.
+ * Has no dependency on SDL, OpenGL or audio so it can run without a window at full speed.
+ * Only owns per game state, level data is shared read only through levels so many worlds can use one copy.
+ */
+struct World {
+private:
+    /*!
+     * Apply the player input to the paddle and ball.
+     * @param in input state
+     */
+    void input(const WorldInput &in);
+
+    /*!
+     * \brief Resolve a contact between a rectangle and a ball.
+     *
+     * Bounces the ball off the rectangle and applies brick hits and score.
+     * @param rect index of the rectangle entity (paddle or brick)
+     * @param ball index of the circle entity
+     * @param hit contact found by the sweep, the ball f_pos is at the contact
+     */
+    void bounce(int rect, int ball, const SweepHit &hit);
+
+    /*!
+     * \brief Move a ball through one tick with continuous collision.
+     *
+     * Finds the earliest contact along the path against the paddle, the bricks the path crosses and the walls,
+     * bounces, and continues with the rest of the movement up to WorldConfig::maxBounces times.
+     * Fast balls can't pass through thin bricks or the paddle, no matter the tick rate.
+     * @param ball index of the circle entity
+     * @param dt fraction of a base tick covered by one tick
+     */
+    void sweep(int ball, float dt);
+
+    /*!
+     * Rebuild the dynamic entity lists if entities were added or removed since they were gathered.
+     */
+    void gatherDynamic();
+
+    /*!
+     * \brief Take the balls that fell below the paddle out of play.
+     *
+     * Extra balls are removed. When the ball is lost an extra ball takes its place, a life is only lost
+     * once no ball is left.
+     */
+    void dropLostBalls();
+
+    std::vector<int> dynamicEntities;   /**<  indices of the non-brick entities */
+    std::vector<int> dynamicRects;      /**<  indices of the moving rectangles (the paddle) */
+    int dynamicRevision = -1;           /**<  entity store revision the dynamic entity lists were gathered from */
+
+public:
+    WorldConfig config;     /**<  simulation values */
+
+    EntityStore entities;   /**<  entity physics data */
+    BrickGrid brickGrid;    /**<  broadphase lookup of the bricks in the current level */
+
+    EntityHandle player;    /**<  player entity handle */
+    EntityHandle ball;      /**<  ball entity handle, extra balls have typeId 1 and follow the bricks */
+
+    std::vector<LevelLayout> levels;    /**<  levels in play order, views into shared level data such as a LevelLibrary */
+
+    int levelId = 0;        /**<  current level id */
+    int playerLives = 3;    /**<  number of player lives */
+    int score = 0;          /**<  current score */
+    int bricksLeft = 0;     /**<  number of bricks in the level that still take hits */
+    int extraBalls = 0;     /**<  extra balls in play besides the ball */
+
+    float pauseTimer = 0;               /**<  seconds left in the current pause */
+    int pauseReason = PAUSE_NONE;       /**<  PauseReason of the current pause */
+
+    bool end = false;           /**<  game over */
+    bool ballCaptured = true;   /**<  is the ball captured on the paddle */
+
+    Vector3D shootVector = Vector3D(0, 2, 0); /**<  initial velocity when shooting the ball from the paddle */
+
+    WorldEvents events;     /**<  events of the last tick */
+
+    World() = default;
+    World(World const&) = delete;           /**<  handles point into the entity store, avoid copies */
+    void operator=(World const&) = delete;  /**<  Don't allow assignment. */
+
+    /*!
+     * \brief Create the player and ball entities.
+     */
+    void startUp();
+
+    /*!
+     * \brief Clear all bricks and extra balls from the entity store, leaves the player and the ball.
+     */
+    void clearLevel();
+
+    /*!
+     * \brief Split extra balls off the ball.
+     *
+     * The new balls start at the ball and fan out around its direction, the split power-up and the
+     * WorldConfig::multiBall serve both use it. Extra balls play by the ball rules but losing one costs no life.
+     * @param count number of balls to add
+     * @return number of balls added, 0 while the ball sits on the paddle
+     */
+    int splitBall(int count);
+
+    /*!
+     * \brief Load level data from a file path.
+     *
+     * Level data is stored in lines where numbers represent how many hits a brick can take. i.e.
+     *  0123210 represents a row of ascending and descending brick values surround by empty space.
+     * Paths ending in .bjl are compiled levels (see LevelFile.h), they are memory mapped instead of parsed.
+     *
+     * @param path system path to the level file
+     */
+    void loadLevel(const std::string &path);
+
+    /*!
+     * \brief Load level data from a string.
+     *
+     * Same format as loadLevel, used when the level is generated instead of read from disk.
+     * Builds the brick grid used by the collision broadphase.
+     *
+     * @param str level data
+     */
+    void loadLevelData(const std::string &str);
+
+    /*!
+     * \brief Load a parsed level.
+     *
+     * Appends all bricks to the entity store in one go and builds the brick grid.
+     * Uses the precomputed brick rectangles of the layout when they were made for the current config.
+     *
+     * @param layout level grid, usually pointing into a memory mapped level file
+     */
+    void loadLevelLayout(const LevelLayout &layout);
+
+    /*!
+     * \brief Update the current level state.
+     * @param win true if the level was won, false otherwise
+     */
+    void levelUpdate(bool win);
+
+    /*!
+     * \brief Advance the world by one tick.
+     *
+     * Applies the input, moves the entities, resolves collisions and level changes.
+     * Events of the tick are stored in events.
+     *
+     * @param in input state for this tick
+     */
+    void step(const WorldInput &in);
+};
+
+#endif //MONOREPO_JSTRACESKI_WORLD_H
@@ -0,0 +1,142 @@
+//
+// Created by jibbo on 3/30/21.
+//
+
+#ifndef MONOREPO_JSTRACESKI_WORLDBATCH_H
+#define MONOREPO_JSTRACESKI_WORLDBATCH_H
+
+#include <World.h>
+#include <Lanes.h>
+#include <LevelFile.h>
+#include <cstdint>
+#include <vector>
+
+/*!
+ * \brief Many single ball games of one level stepped together, one game per SIMD lane.
+ *
+ * Ball position and velocity, paddle state and inputs are stored as lane arrays and stepped with Lanes kernels,
+ * so a core advances Lanes::WIDTH games with the instructions World::step spends on one.
+ * Each brick keeps a bitmask of the lanes it is still alive in, bricks dead in every lane cost one integer test,
+ * and a vector only tests the rows its balls overlap.
+ *
+ * Follows the World rules with the WorldConfig values: the ball is swept against the paddle, the bricks and the
+ * walls up to maxBounces times a tick, so a lane breaks several bricks in a tick like World does.
+ * There is no pause, a lane stops when its level is cleared or its lives run out and waits for resetLane.
+ *
+ * Meant for Monte Carlo and reinforcement learning runs, the window game keeps using World.
+ */
+class WorldBatch {
+private:
+    int count = 0;      /**<  games in the batch */
+    int padded = 0;     /**<  lane array length, count rounded up to whole vectors */
+
+    std::vector<float> storage;     /**<  lane arrays, carved out at LANES_ALIGNMENT */
+    float *running = nullptr;       /**<  lane array, 1 while the game in the lane is playing */
+
+    // shared brick layout, one entry per brick
+    std::vector<float> brickX;      /**<  brick center x */
+    std::vector<float> brickY;      /**<  brick center y */
+    std::vector<float> brickHalfW;  /**<  half brick width */
+    std::vector<float> brickHalfH;  /**<  half brick height */
+    std::vector<uint8_t> brickHits; /**<  hits of every brick at the start of the level */
+    std::vector<int> rowFirst;      /**<  first brick of every row with bricks, then the brick count */
+    std::vector<float> rowBottom;   /**<  lowest brick edge of every row */
+    std::vector<float> rowTop;      /**<  highest brick edge of every row */
+    float fieldBottom = 0;          /**<  lowest brick edge, balls below it skip the brick loop */
+
+    // per lane brick state, brick major
+    std::vector<uint32_t> alive;    /**<  bricks * groups lane bitmasks, bit set while the brick takes hits */
+    std::vector<uint8_t> hits;      /**<  bricks * padded hits left */
+
+    /*!
+     * Step one vector of lanes.
+     * @param group index of the vector, lanes group * Lanes::WIDTH and up
+     */
+    void stepGroup(int group);
+
+public:
+    WorldConfig config;         /**<  simulation values, shared by every lane */
+    Vector3D shootVector = Vector3D(0, 2, 0); /**<  initial velocity when shooting the ball from the paddle */
+
+    float paddleWidth = 100;    /**<  paddle width */
+    float paddleHeight = 10;    /**<  paddle height */
+    float paddleY = 0;          /**<  paddle center y, set by startUp */
+    float paddleDrag = 0.95f;   /**<  paddle velocity kept every base tick */
+    float ballRadius = 10;      /**<  ball radius */
+
+    // lane arrays, padded long, LANES_ALIGNMENT aligned
+    float *ballX = nullptr;     /**<  ball center x */
+    float *ballY = nullptr;     /**<  ball center y */
+    float *ballVX = nullptr;    /**<  ball velocity x */
+    float *ballVY = nullptr;    /**<  ball velocity y */
+    float *paddleX = nullptr;   /**<  paddle center x */
+    float *paddleVX = nullptr;  /**<  paddle velocity x */
+    float *captured = nullptr;  /**<  1 if the ball sits on the paddle, 0 otherwise */
+    float *left = nullptr;      /**<  input, 1 to accelerate the paddle to the left */
+    float *right = nullptr;     /**<  input, 1 to accelerate the paddle to the right */
+    float *shoot = nullptr;     /**<  input, 1 to release the ball */
+
+    // per lane results
+    std::vector<int> lives;         /**<  player lives */
+    std::vector<int> score;         /**<  current score */
+    std::vector<int> bricksLeft;    /**<  bricks that still take hits */
+    std::vector<int> ticks;         /**<  ticks played since the lane was reset */
+    std::vector<int> tickHits;      /**<  paddle and brick contacts of the last tick */
+    std::vector<uint8_t> finished;  /**<  PAUSE_WIN or PAUSE_LOSE once the game ended, PAUSE_NONE while playing */
+
+    WorldBatch() = default;
+    WorldBatch(WorldBatch const&) = delete;         /**<  lane pointers point into storage */
+    void operator=(WorldBatch const&) = delete;     /**<  Don't allow assignment. */
+
+    /*!
+     * \brief Allocate the lanes and reset every game.
+     *
+     * The config has to be set before, the level stays shared and has to outlive the batch.
+     * @param games number of games
+     * @param level level every lane plays
+     */
+    void startUp(int games, const LevelLayout &level);
+
+    /*!
+     * \brief Restart the game in a lane at the start of the level.
+     * @param lane game index
+     */
+    void resetLane(int lane);
+
+    /*!
+     * \brief Set the input of a lane for the next step.
+     * @param lane game index
+     * @param in input state
+     */
+    void setInput(int lane, const WorldInput &in);
+
+    /*!
+     * \brief Advance every game that hasn't finished by one tick.
+     */
+    void step();
+
+    /*!
+     * \brief Number of games.
+     */
+    int size() const {
+        return count;
+    }
+
+    /*!
+     * \brief Number of bricks in the level.
+     */
+    int brickCount() const {
+        return (int) brickX.size();
+    }
+
+    /*!
+     * \brief Hits left on a brick in a lane.
+     * @param brick brick index in level order
+     * @param lane game index
+     */
+    int brickHitsLeft(int brick, int lane) const {
+        return hits[(size_t) brick * padded + lane];
+    }
+};
+
+#endif //MONOREPO_JSTRACESKI_WORLDBATCH_H
@@ -0,0 +1,102 @@
+//
+// Created by jibbo on 3/29/21.
+//
+
+#include <Audio.h>
+#include <cstdio>
+
+void Audio::drainCommands() {
+    ClipCommand c;
+    while (commands.pop(c)) {
+        switch (c.type) {
+            case ClipCommand::PLAY:
+                voices.play(c.clip);
+                break;
+            case ClipCommand::STOP:
+                voices.stop(c.clip);
+                break;
+            case ClipCommand::LOOP:
+                c.clip->loop = c.loop;
+                break;
+        }
+    }
+}
+
+void Audio::callback(void *userdata, Uint8 *stream, int len) {
+    Audio *audio = (Audio *) userdata;
+    audio->drainCommands();
+    audio->voices.mix(stream, (Uint32) len);
+}
+
+bool Audio::open() {
+    SDL_AudioSpec fmt;
+
+    fmt.freq = 44100;
+    fmt.format = AUDIO_S16;
+    fmt.channels = 2;
+    fmt.samples = 4096;
+    fmt.callback = Audio::callback;
+    fmt.userdata = this;
+
+    // the callback shouldn't allocate, size the mix buffer up front
+    voices.reserve((size_t) fmt.samples * fmt.channels);
+
+    /* Open the audio device */
+    if ( SDL_OpenAudio(&fmt, NULL) < 0 ){
+        fprintf(stderr, "Couldn't open audio: %s\n", SDL_GetError());
+        return false;
+    }
+    opened = true;
+
+    /* Start playing */
+    SDL_PauseAudio(0);
+
+    return true;
+}
+
+void Audio::close() {
+    if (opened) {
+        SDL_CloseAudio();
+        opened = false;
+    }
+
+    // the callback is stopped, whatever is still queued can be dropped
+    ClipCommand c;
+    while (commands.pop(c)) {
+    }
+    voices.stopAll();
+}
+
+void Audio::play(Clip *clip) {
+    if (clip == nullptr) {
+        return;
+    }
+
+    ClipCommand command;
+    command.type = ClipCommand::PLAY;
+    command.clip = clip;
+    send(command);
+}
+
+void Audio::stop(Clip *clip) {
+    if (clip == nullptr) {
+        return;
+    }
+
+    ClipCommand command;
+    command.type = ClipCommand::STOP;
+    command.clip = clip;
+    send(command);
+}
+
+void Audio::loop(Clip *clip, bool loop) {
+    if (clip == nullptr) {
+        return;
+    }
+
+    ClipCommand command;
+    command.type = ClipCommand::LOOP;
+    command.clip = clip;
+    command.loop = loop;
+    send(command);
+}
@@ -0,0 +1,113 @@
+//
+// Created by jibbo on 3/25/21.
+//
+
+#include <AudioMixer.h>
+#include <cstring>
+
+#if defined(__AVX2__)
+    #include <immintrin.h>
+    #define BREAKJOE_MIX_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define BREAKJOE_MIX_SSE2
+#endif
+
+void AudioMixer::reserve(size_t count) {
+    if (capacity >= count) {
+        return;
+    }
+
+    storage.assign(count + ALIGNMENT / sizeof(int32_t), 0);
+    size_t misalignment = (size_t) storage.data() % ALIGNMENT;
+    accum = storage.data() + (misalignment ? (ALIGNMENT - misalignment) / sizeof(int32_t) : 0);
+    capacity = count;
+}
+
+void AudioMixer::begin(size_t count) {
+    reserve(count);
+    samples = count;
+    memset(accum, 0, count * sizeof(int32_t));
+}
+
+void AudioMixer::add(size_t offset, const int16_t *src, size_t count) {
+    accumulate(&accum[offset], src, count);
+}
+
+void AudioMixer::resolve(int16_t *out) const {
+    saturate(out, accum, samples);
+}
+
+const char *AudioMixer::kernel() {
+#if defined(BREAKJOE_MIX_AVX2)
+    return "avx2";
+#elif defined(BREAKJOE_MIX_SSE2)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+void AudioMixer::accumulateScalar(int32_t *dst, const int16_t *src, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        dst[i] += src[i];
+    }
+}
+
+void AudioMixer::saturateScalar(int16_t *dst, const int32_t *src, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        int32_t s = src[i];
+        if (s > INT16_MAX) {
+            s = INT16_MAX;
+        } else if (s < INT16_MIN) {
+            s = INT16_MIN;
+        }
+        dst[i] = (int16_t) s;
+    }
+}
+
+void AudioMixer::accumulate(int32_t *dst, const int16_t *src, size_t count) {
+    size_t i = 0;
+#if defined(BREAKJOE_MIX_AVX2)
+    for (; i + 16 <= count; i += 16) {
+        __m256i a = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *) &src[i]));
+        __m256i b = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *) &src[i + 8]));
+        __m256i da = _mm256_loadu_si256((const __m256i *) &dst[i]);
+        __m256i db = _mm256_loadu_si256((const __m256i *) &dst[i + 8]);
+        _mm256_storeu_si256((__m256i *) &dst[i], _mm256_add_epi32(da, a));
+        _mm256_storeu_si256((__m256i *) &dst[i + 8], _mm256_add_epi32(db, b));
+    }
+#elif defined(BREAKJOE_MIX_SSE2)
+    for (; i + 8 <= count; i += 8) {
+        __m128i s = _mm_loadu_si128((const __m128i *) &src[i]);
+        // interleaving a value with itself and shifting back down sign extends it to 32 bit
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(s, s), 16);
+        __m128i dlo = _mm_loadu_si128((const __m128i *) &dst[i]);
+        __m128i dhi = _mm_loadu_si128((const __m128i *) &dst[i + 4]);
+        _mm_storeu_si128((__m128i *) &dst[i], _mm_add_epi32(dlo, lo));
+        _mm_storeu_si128((__m128i *) &dst[i + 4], _mm_add_epi32(dhi, hi));
+    }
+#endif
+    accumulateScalar(&dst[i], &src[i], count - i);
+}
+
+void AudioMixer::saturate(int16_t *dst, const int32_t *src, size_t count) {
+    size_t i = 0;
+#if defined(BREAKJOE_MIX_AVX2)
+    for (; i + 16 <= count; i += 16) {
+        __m256i a = _mm256_loadu_si256((const __m256i *) &src[i]);
+        __m256i b = _mm256_loadu_si256((const __m256i *) &src[i + 8]);
+        // packs works per 128 bit lane, reorder the 64 bit quarters back into sample order
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), 0xD8);
+        _mm256_storeu_si256((__m256i *) &dst[i], packed);
+    }
+#elif defined(BREAKJOE_MIX_SSE2)
+    for (; i + 8 <= count; i += 8) {
+        __m128i a = _mm_loadu_si128((const __m128i *) &src[i]);
+        __m128i b = _mm_loadu_si128((const __m128i *) &src[i + 4]);
+        _mm_storeu_si128((__m128i *) &dst[i], _mm_packs_epi32(a, b));
+    }
+#endif
+    saturateScalar(&dst[i], &src[i], count - i);
+}
@@ -0,0 +1,204 @@
+//
+// Created by jibbo on 4/2/21.
+//
+
+#include <BreakjoeEnv.h>
+#include <World.h>
+#include <LevelFile.h>
+#include <ThreadPool.h>
+#include <SoftRaster.h>
+#include <SceneDraw.h>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+/*!
+ * \brief Environment set behind the C handle.
+ */
+struct BreakjoeEnv {
+    LevelLibrary library;                       /**<  levels, shared read only by every world */
+    std::vector<std::unique_ptr<World>> worlds; /**<  one game per environment, worlds can't be moved */
+    std::vector<int> ticks;                     /**<  ticks played in the current game of every environment */
+    std::unique_ptr<ThreadPool> pool;           /**<  steps the environments */
+    int maxTicks = 0;                           /**<  tick limit of a game, 0 for none */
+    int observationSize = BREAKJOE_OBS_CELLS;   /**<  floats per observation */
+};
+
+/*!
+ * Start a new game in an environment.
+ * @param env environment set
+ * @param i environment index
+ */
+static void resetGame(BreakjoeEnv *env, int i) {
+    const std::vector<LevelLayout> &levels = env->library.layouts();
+    const LevelLayout &level = levels[i % levels.size()];
+
+    // a fresh world is the only way back to the exact start state, the level data itself is shared
+    std::unique_ptr<World> world(new World());
+    world->levels.push_back(level);
+    world->startUp();
+    world->loadLevelLayout(level);
+
+    env->worlds[i] = std::move(world);
+    env->ticks[i] = 0;
+}
+
+/*!
+ * Write the observation of an environment.
+ * @param env environment set
+ * @param i environment index
+ * @param out observationSize floats
+ */
+static void observe(const BreakjoeEnv *env, int i, float *out) {
+    const World &world = *env->worlds[i];
+    const EntityStore &store = world.entities;
+    int ball = world.ball.id;
+    int player = world.player.id;
+
+    out[BREAKJOE_OBS_BALL_X] = store.pos[ball].x;
+    out[BREAKJOE_OBS_BALL_Y] = store.pos[ball].y;
+    out[BREAKJOE_OBS_BALL_VX] = store.vel[ball].x;
+    out[BREAKJOE_OBS_BALL_VY] = store.vel[ball].y;
+    out[BREAKJOE_OBS_PADDLE_X] = store.pos[player].x;
+    out[BREAKJOE_OBS_PADDLE_VX] = store.vel[player].x;
+    out[BREAKJOE_OBS_CAPTURED] = world.ballCaptured ? 1.0f : 0.0f;
+    out[BREAKJOE_OBS_LIVES] = (float) world.playerLives;
+    out[BREAKJOE_OBS_BRICKS_LEFT] = (float) world.bricksLeft;
+
+    // the grid keeps the cell order of the level, so cell k of the observation is the same brick in every tick
+    const std::vector<int> &cells = world.brickGrid.cells;
+    float *hits = out + BREAKJOE_OBS_CELLS;
+    int cellCount = env->observationSize - BREAKJOE_OBS_CELLS;
+    int used = (int) cells.size() < cellCount ? (int) cells.size() : cellCount;
+    for (int k = 0; k < used; ++k) {
+        int id = cells[k];
+        hits[k] = id >= 0 ? (float) store.hits[id] : 0.0f;
+    }
+    for (int k = used; k < cellCount; ++k) {
+        hits[k] = 0.0f;
+    }
+}
+
+/*!
+ * Step one environment, restarting its game when it ends.
+ * @param env environment set
+ * @param i environment index
+ * @param action BREAKJOE_ACTION_ bits
+ * @param reward receives the score gained
+ * @param done receives the BREAKJOE_DONE_ value
+ */
+static void stepGame(BreakjoeEnv *env, int i, uint8_t action, float &reward, uint8_t &done) {
+    World &world = *env->worlds[i];
+
+    WorldInput in;
+    in.left = (action & BREAKJOE_ACTION_LEFT) != 0;
+    in.right = (action & BREAKJOE_ACTION_RIGHT) != 0;
+    in.shoot = (action & BREAKJOE_ACTION_SHOOT) != 0;
+
+    int score = world.score;
+    world.step(in);
+    ++env->ticks[i];
+
+    done = 0;
+    if (world.events.levelChanged) {
+        done = world.pauseReason == PAUSE_WIN ? BREAKJOE_DONE_CLEARED : BREAKJOE_DONE_LOST;
+    } else if (env->maxTicks > 0 && env->ticks[i] >= env->maxTicks) {
+        done = BREAKJOE_DONE_TIMEOUT;
+    }
+
+    // losing resets the score to 0, that isn't a reward
+    reward = done == BREAKJOE_DONE_LOST ? 0.0f : (float) (world.score - score);
+
+    if (done != 0) {
+        resetGame(env, i);
+    }
+}
+
+BreakjoeEnv *breakjoe_env_create(const char *const *levelPaths, int levelCount, int envs, int threads,
+                                 int maxTicks) {
+    if (levelPaths == nullptr || levelCount <= 0 || envs <= 0) {
+        printf("breakjoe_env_create: needs at least one level and one environment\n");
+        return nullptr;
+    }
+
+    std::unique_ptr<BreakjoeEnv> env(new BreakjoeEnv());
+    for (int i = 0; i < levelCount; ++i) {
+        if (levelPaths[i] == nullptr || !env->library.load(levelPaths[i])) {
+            printf("breakjoe_env_create: unable to load level %s\n", levelPaths[i] ? levelPaths[i] : "(null)");
+            return nullptr;
+        }
+    }
+
+    uint32_t cells = 0;
+    for (const LevelLayout &level : env->library.layouts()) {
+        cells = level.cells > cells ? level.cells : cells;
+    }
+    env->observationSize = BREAKJOE_OBS_CELLS + (int) cells;
+    env->maxTicks = maxTicks > 0 ? maxTicks : 0;
+
+    env->worlds.resize(envs);
+    env->ticks.resize(envs);
+    env->pool.reset(new ThreadPool(threads));
+    breakjoe_env_reset(env.get(), nullptr);
+
+    return env.release();
+}
+
+void breakjoe_env_destroy(BreakjoeEnv *env) {
+    delete env;
+}
+
+int breakjoe_env_count(const BreakjoeEnv *env) {
+    return (int) env->worlds.size();
+}
+
+int breakjoe_env_observation_size(const BreakjoeEnv *env) {
+    return env->observationSize;
+}
+
+void breakjoe_env_reset(BreakjoeEnv *env, float *observations) {
+    env->pool->parallelFor((int) env->worlds.size(), [env, observations](int i) {
+        resetGame(env, i);
+        if (observations != nullptr) {
+            observe(env, i, observations + (size_t) i * env->observationSize);
+        }
+    });
+}
+
+void breakjoe_env_step(BreakjoeEnv *env, const uint8_t *actions, float *rewards, uint8_t *dones,
+                       float *observations) {
+    env->pool->parallelFor((int) env->worlds.size(), [=](int i) {
+        stepGame(env, i, actions[i], rewards[i], dones[i]);
+        if (observations != nullptr) {
+            observe(env, i, observations + (size_t) i * env->observationSize);
+        }
+    });
+}
+
+void breakjoe_env_observation(const BreakjoeEnv *env, float *observations) {
+    // the pool is only borrowed to spread the writes, the environments aren't changed
+    env->pool->parallelFor((int) env->worlds.size(), [env, observations](int i) {
+        observe(env, i, observations + (size_t) i * env->observationSize);
+    });
+}
+
+int breakjoe_env_render(const BreakjoeEnv *env, int width, int height, int channels, uint8_t *pixels) {
+    if (pixels == nullptr || width <= 0 || height <= 0 || (channels != 1 && channels != 4)) {
+        printf("breakjoe_env_render: invalid %dx%d image with %d channels\n", width, height, channels);
+        return 0;
+    }
+
+    size_t frameSize = (size_t) width * height * channels;
+    env->pool->parallelFor((int) env->worlds.size(), [=](int i) {
+        const World &world = *env->worlds[i];
+
+        // the raster only points into the caller buffer, setting one up per frame allocates nothing
+        SoftRaster raster;
+        raster.setTarget(pixels + (size_t) i * frameSize, width, height, channels,
+                         world.config.screenWidth, world.config.screenHeight);
+        raster.clear(0, 0, 0);
+        drawWorldEntities(raster, world, 1.0f);
+    });
+    return 1;
+}
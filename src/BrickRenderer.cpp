@@ -0,0 +1,144 @@
+//
+// Created by jibbo on 4/6/21.
+//
+
+#include <BrickRenderer.h>
+#include <SceneDraw.h>
+#include <cstddef>
+#include <cstdio>
+
+bool BrickRenderer::init(GLuint programId, int width, int height) {
+    program = programId;
+
+    cornerLoc = glGetAttribLocation(program, "LCorner");
+    rectLoc = glGetAttribLocation(program, "LRect");
+    hitsLoc = glGetAttribLocation(program, "LHits");
+    projectionLoc = glGetUniformLocation(program, "LProjection");
+    if (cornerLoc == -1 || rectLoc == -1 || hitsLoc == -1 || projectionLoc == -1) {
+        printf("Brick program is missing LCorner/LRect/LHits attributes or LProjection\n");
+        return false;
+    }
+
+    // the colors never change, set them once
+    float colors[BRICK_COLORS * 4] = {0};
+    for (int hits = 0; hits < BRICK_COLORS; ++hits) {
+        float *c = colors + hits * 4;
+        c[3] = brickColor(hits, c) ? 1.0f : 0.0f;
+    }
+    glUseProgram(program);
+    glUniform4fv(glGetUniformLocation(program, "LHitColors"), BRICK_COLORS, colors);
+    glUseProgram(0);
+    setScreenSize(width, height);
+
+    // two triangles of a quad one unit wide centered on the origin
+    const float corners[12] = {
+            -0.5f, 0.5f, 0.5f, 0.5f, 0.5f, -0.5f,
+            -0.5f, 0.5f, 0.5f, -0.5f, -0.5f, -0.5f
+    };
+
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &cornerVbo);
+    glGenBuffers(1, &instanceVbo);
+
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, cornerVbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+    glEnableVertexAttribArray(cornerLoc);
+    glVertexAttribPointer(cornerLoc, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (const GLvoid *) 0);
+
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVbo);
+    glEnableVertexAttribArray(rectLoc);
+    glVertexAttribPointer(rectLoc, 4, GL_FLOAT, GL_FALSE, sizeof(BrickInstance),
+                          (const GLvoid *) offsetof(BrickInstance, x));
+    glVertexAttribDivisor(rectLoc, 1);
+    glEnableVertexAttribArray(hitsLoc);
+    glVertexAttribPointer(hitsLoc, 1, GL_FLOAT, GL_FALSE, sizeof(BrickInstance),
+                          (const GLvoid *) offsetof(BrickInstance, hits));
+    glVertexAttribDivisor(hitsLoc, 1);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    return true;
+}
+
+void BrickRenderer::setScreenSize(int width, int height) {
+    Matrix3D projection = Orthographic2D(0, (float) width, 0, (float) height);
+
+    glUseProgram(program);
+    glUniformMatrix3fv(projectionLoc, 1, GL_FALSE, &projection(0, 0));
+    glUseProgram(0);
+}
+
+void BrickRenderer::load(const World &world) {
+    const EntityStore &store = world.entities;
+
+    instances.clear();
+    instanceOf.assign(store.size(), -1);
+    for (int i = 0; i < store.size(); ++i) {
+        if (store.typeId[i] != 2) {
+            continue;
+        }
+        BrickInstance b = {store.pos[i].x, store.pos[i].y, store.width[i], store.height[i], (float) store.hits[i]};
+        instanceOf[i] = (int) instances.size();
+        instances.push_back(b);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVbo);
+    glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(BrickInstance), instances.data(), GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    uploads = (int) instances.size();
+}
+
+void BrickRenderer::update(const World &world) {
+    if (world.events.levelChanged) {
+        load(world);
+        return;
+    }
+
+    // brick ids stay the same while a level is played, extra balls are only added after them
+    const EntityStore &store = world.entities;
+    bool bound = false;
+    for (int id : world.events.bricksHit) {
+        int k = id < (int) instanceOf.size() ? instanceOf[id] : -1;
+        // a brick hit by several balls in one tick is listed once per contact
+        float hits = (float) store.hits[id];
+        if (k < 0 || hits == instances[k].hits) {
+            continue;
+        }
+        instances[k].hits = hits;
+
+        if (!bound) {
+            glBindBuffer(GL_ARRAY_BUFFER, instanceVbo);
+            bound = true;
+        }
+        glBufferSubData(GL_ARRAY_BUFFER, k * sizeof(BrickInstance) + offsetof(BrickInstance, hits), sizeof(float),
+                        &instances[k].hits);
+        ++uploads;
+    }
+    if (bound) {
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+}
+
+void BrickRenderer::draw() {
+    if (instances.empty()) {
+        return;
+    }
+
+    glUseProgram(program);
+    glBindVertexArray(vao);
+    glDrawArraysInstanced(GL_TRIANGLES, 0, 6, (GLsizei) instances.size());
+    glBindVertexArray(0);
+    glUseProgram(0);
+}
+
+void BrickRenderer::shutDown() {
+    glDeleteBuffers(1, &cornerVbo);
+    glDeleteBuffers(1, &instanceVbo);
+    glDeleteVertexArrays(1, &vao);
+    cornerVbo = 0;
+    instanceVbo = 0;
+    vao = 0;
+    instances.clear();
+    instanceOf.clear();
+}
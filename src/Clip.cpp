@@ -1,8 +0,0 @@
-//
-// Created by jibbo on 2/22/21.
-//
-
-#include <Clip.h>
-#include <vector>
-
-std::vector<Clip *> Clip::sounds;
\ No newline at end of file
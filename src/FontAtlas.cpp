@@ -0,0 +1,291 @@
+//
+// Created by jibbo on 3/22/21.
+//
+
+#include <FontAtlas.h>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+static const float FAR = 1e20f;
+
+/*!
+ * Squared distance transform of one row or column, Felzenszwalb and Huttenlocher's lower envelope of parabolas.
+ * @param f 0 at the features, FAR elsewhere
+ * @param n number of samples
+ * @param d squared distance to the nearest feature
+ * @param v scratch, n ints
+ * @param z scratch, n + 1 floats
+ */
+static void distanceTransform1D(const float *f, int n, float *d, int *v, float *z) {
+    int k = 0;
+    v[0] = 0;
+    z[0] = -FAR;
+    z[1] = FAR;
+    for (int q = 1; q < n; ++q) {
+        float s;
+        while (true) {
+            int p = v[k];
+            s = ((f[q] + (float) (q * q)) - (f[p] + (float) (p * p))) / (float) (2 * (q - p));
+            if (s > z[k] || k == 0) {
+                break;
+            }
+            --k;
+        }
+        ++k;
+        v[k] = q;
+        z[k] = s;
+        z[k + 1] = FAR;
+    }
+
+    k = 0;
+    for (int q = 0; q < n; ++q) {
+        while (z[k + 1] < (float) q) {
+            ++k;
+        }
+        d[q] = (float) ((q - v[k]) * (q - v[k])) + f[v[k]];
+    }
+}
+
+/*!
+ * Squared distance transform of a grid, columns first and then rows.
+ * @param grid 0 at the features, FAR elsewhere, replaced by the squared distances
+ * @param w grid width
+ * @param h grid height
+ */
+static void distanceTransform2D(std::vector<float> &grid, int w, int h) {
+    int n = w > h ? w : h;
+    std::vector<float> f(n), d(n), z(n + 1);
+    std::vector<int> v(n);
+
+    for (int x = 0; x < w; ++x) {
+        for (int y = 0; y < h; ++y) {
+            f[y] = grid[(size_t) y * w + x];
+        }
+        distanceTransform1D(f.data(), h, d.data(), v.data(), z.data());
+        for (int y = 0; y < h; ++y) {
+            grid[(size_t) y * w + x] = d[y];
+        }
+    }
+    for (int y = 0; y < h; ++y) {
+        float *row = &grid[(size_t) y * w];
+        distanceTransform1D(row, w, d.data(), v.data(), z.data());
+        memcpy(row, d.data(), w * sizeof(float));
+    }
+}
+
+/*!
+ * Floor of a / b for positive b.
+ */
+static int floorDiv(int a, int b) {
+    return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+FontAtlas::~FontAtlas() {
+    close();
+}
+
+bool FontAtlas::open(const char *path, int pixelSize, int distanceSpread) {
+    close();
+
+    if (FT_Init_FreeType(&library)) {
+        printf("ERROR::FREETYPE: Could not init FreeType Library\n");
+        library = nullptr;
+        return false;
+    }
+
+    // MODIFIED from https://learnopengl.com/In-Practice/Text-Rendering
+    if (FT_New_Face(library, path, 0, &face)) {
+        printf("ERROR::FREETYPE: Failed to load font %s\n", path);
+        face = nullptr;
+        close();
+        return false;
+    }
+
+    // distance fields are measured on outlines rendered larger, then sampled down to pixelSize
+    spread = distanceSpread > 0 ? distanceSpread : 0;
+    int renderSize = spread > 0 ? pixelSize * DISTANCE_UPSCALE : pixelSize;
+    FT_Set_Pixel_Sizes(face, renderSize, renderSize);
+    return true;
+}
+
+void FontAtlas::close() {
+    if (face != nullptr) {
+        FT_Done_Face(face);
+        face = nullptr;
+    }
+    if (library != nullptr) {
+        FT_Done_FreeType(library);
+        library = nullptr;
+    }
+
+    glyphs.clear();
+    pixels.clear();
+    height = 0;
+    spread = 0;
+    shelfX = PADDING;
+    shelfY = PADDING;
+    shelfHeight = 0;
+    markClean();
+    ++generation;
+}
+
+void FontAtlas::pack(int w, int h, int &outX, int &outY) {
+    if (shelfX + w + PADDING > width) {
+        shelfY += shelfHeight + PADDING;
+        shelfX = PADDING;
+        shelfHeight = 0;
+    }
+
+    outX = shelfX;
+    outY = shelfY;
+
+    shelfX += w + PADDING;
+    if (h > shelfHeight) {
+        shelfHeight = h;
+    }
+
+    // rows are appended below the existing ones so growing keeps the packed pixels in place,
+    // doubling keeps the number of resizes and texture coordinate changes small
+    int needed = shelfY + shelfHeight + PADDING;
+    if (needed > height) {
+        int grown = height > 0 ? height : 64;
+        while (grown < needed) {
+            grown *= 2;
+        }
+        height = grown;
+        pixels.resize((size_t) width * height, 0);
+        updateCoordinates();
+        ++generation;
+    }
+}
+
+void FontAtlas::updateCoordinates() {
+    for (auto &entry : glyphs) {
+        Glyph &g = entry.second;
+        g.u0 = (float) g.atlasX / (float) width;
+        g.v0 = (float) g.atlasY / (float) height;
+        g.u1 = (float) (g.atlasX + g.width) / (float) width;
+        g.v1 = (float) (g.atlasY + g.height) / (float) height;
+    }
+}
+
+void FontAtlas::distanceField(Glyph &g, std::vector<unsigned char> &field) const {
+    const FT_GlyphSlot slot = face->glyph;
+    const FT_Bitmap &bitmap = slot->bitmap;
+    const int up = DISTANCE_UPSCALE;
+
+    // atlas pixel box around the upscaled bitmap with spread pixels of margin, y grows upwards
+    int left = floorDiv(slot->bitmap_left, up) - spread;
+    int right = -floorDiv(-(slot->bitmap_left + (int) bitmap.width), up) + spread;
+    int top = -floorDiv(-slot->bitmap_top, up) + spread;
+    int bottom = floorDiv(slot->bitmap_top - (int) bitmap.rows, up) - spread;
+
+    g.x = left;
+    g.y = top;
+    g.width = right - left;
+    g.height = top - bottom;
+
+    // the box at the upscaled size, rows from the top
+    int gw = (int) g.width * up;
+    int gh = (int) g.height * up;
+    int shiftX = slot->bitmap_left - left * up;
+    int shiftY = top * up - slot->bitmap_top;
+
+    std::vector<bool> inside((size_t) gw * gh, false);
+    for (unsigned int row = 0; row < bitmap.rows; ++row) {
+        const unsigned char *src = bitmap.buffer + row * bitmap.pitch;
+        for (unsigned int col = 0; col < bitmap.width; ++col) {
+            if (src[col] >= 128) {
+                inside[(size_t) (row + shiftY) * gw + col + shiftX] = true;
+            }
+        }
+    }
+
+    // squared distances to the nearest inside and the nearest outside sample
+    std::vector<float> toInside((size_t) gw * gh);
+    std::vector<float> toOutside((size_t) gw * gh);
+    for (size_t i = 0; i < inside.size(); ++i) {
+        toInside[i] = inside[i] ? 0 : FAR;
+        toOutside[i] = inside[i] ? FAR : 0;
+    }
+    distanceTransform2D(toInside, gw, gh);
+    distanceTransform2D(toOutside, gw, gh);
+
+    // every atlas pixel averages the signed distances of the 2x2 samples around its center,
+    // the outline lies half a sample past the last sample on either side of it
+    field.resize((size_t) g.width * g.height);
+    float toValue = 1.0f / (2.0f * (float) spread * (float) up);
+    for (int y = 0; y < (int) g.height; ++y) {
+        for (int x = 0; x < (int) g.width; ++x) {
+            float sum = 0;
+            for (int k = 0; k < 4; ++k) {
+                size_t i = (size_t) (y * up + up / 2 - 1 + k / 2) * gw + x * up + up / 2 - 1 + k % 2;
+                sum += inside[i] ? 0.5f - sqrtf(toOutside[i]) : sqrtf(toInside[i]) - 0.5f;
+            }
+            float value = 0.5f - sum / 4.0f * toValue;
+            value = value < 0 ? 0 : (value > 1 ? 1 : value);
+            field[(size_t) y * g.width + x] = (unsigned char) (value * 255.0f + 0.5f);
+        }
+    }
+}
+
+bool FontAtlas::rasterize(uint32_t codepoint) {
+    // failed glyphs stay in the map empty so they are only tried once
+    Glyph &g = glyphs[codepoint];
+    if (face == nullptr || FT_Load_Char(face, codepoint, FT_LOAD_RENDER)) {
+        return false;
+    }
+
+    const FT_Bitmap &bitmap = face->glyph->bitmap;
+    const unsigned char *source = bitmap.buffer;
+    int pitch = bitmap.pitch;
+
+    std::vector<unsigned char> field;
+    if (spread > 0) {
+        g.advance = face->glyph->advance.x / DISTANCE_UPSCALE;
+        if (bitmap.width > 0 && bitmap.rows > 0) {
+            distanceField(g, field);
+            source = field.data();
+            pitch = (int) g.width;
+        }
+    } else {
+        g.width = bitmap.width;
+        g.height = bitmap.rows;
+        g.x = face->glyph->bitmap_left;
+        g.y = face->glyph->bitmap_top;
+        g.advance = face->glyph->advance.x;
+    }
+
+    pack((int) g.width, (int) g.height, g.atlasX, g.atlasY);
+
+    for (unsigned int row = 0; row < g.height; ++row) {
+        memcpy(&pixels[(size_t) (g.atlasY + row) * width + g.atlasX], source + row * pitch, g.width);
+    }
+
+    g.u0 = (float) g.atlasX / (float) width;
+    g.v0 = (float) g.atlasY / (float) height;
+    g.u1 = (float) (g.atlasX + g.width) / (float) width;
+    g.v1 = (float) (g.atlasY + g.height) / (float) height;
+
+    int bottom = g.atlasY + (int) g.height;
+    if (dirtyBottom <= dirtyTop) {
+        dirtyTop = g.atlasY;
+        dirtyBottom = bottom;
+    } else {
+        dirtyTop = g.atlasY < dirtyTop ? g.atlasY : dirtyTop;
+        dirtyBottom = bottom > dirtyBottom ? bottom : dirtyBottom;
+    }
+    return true;
+}
+
+int FontAtlas::require(const std::string &text) {
+    int failed = 0;
+    for (size_t i = 0; i < text.size();) {
+        uint32_t codepoint = nextCodepoint(text, i);
+        if (glyphs.find(codepoint) == glyphs.end() && !rasterize(codepoint)) {
+            ++failed;
+        }
+    }
+    return failed;
+}
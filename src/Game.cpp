@@ -68,13 +68,21 @@ void printShaderLog(GLuint shader) {
 }
 
 
+// Message key of the text shown during a pause.
+static const char* pauseMessage(int reason) {
+    switch (reason) {
+        case PAUSE_WIN:
+            return "you_win";
+        case PAUSE_LOSE:
+            return "you_lose";
+        default:
+            return "next_level";
+    }
+}
+
 int Game::SCREEN_WIDTH = 1080;
 int Game::SCREEN_HEIGHT = 720;
-float Game::PADDLE_SPEED = 0.8f;
-float Game::MAX_SPEED = 10.0f;
-int Game::BRICK_TOP_OFFSET = 80;
-int Game::BRICK_HEIGHT = 20;
-int Game::BRICK_SPACING = 5;
+int Game::TICK_RATE = 240;
 
 Game::Game() {
 
@@ -146,24 +154,21 @@ bool Game::init() {
     return true;
 }
 
-bool Game::initGL() {
+/*!
+ * Compile and link a shader program.
+ * @param vertexSource vertex shader source
+ * @param fragmentSource fragment shader source
+ * @return linked program, 0 if a shader doesn't compile or the program doesn't link
+ */
+static GLuint linkProgram(const GLchar *vertexSource, const GLchar *fragmentSource) {
     //Generate program
-    gProgramID = glCreateProgram();
+    GLuint program = glCreateProgram();
 
     //Create vertex shader
     GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
 
-    //Get vertex source
-    const GLchar* vertexShaderSource[] = {
-            "#version 140\n"
-            "void main() {\n"
-            "\t//Process vertex\n"
-            "\tgl_Position = gl_ProjectionMatrix * gl_ModelViewMatrix * gl_Vertex;\n"
-            "}"
-    };
-
     //Set vertex source
-    glShaderSource(vertexShader, 1, vertexShaderSource, NULL);
+    glShaderSource(vertexShader, 1, &vertexSource, NULL);
 
     //Compile vertex source
     glCompileShader(vertexShader);
@@ -174,22 +179,17 @@ bool Game::initGL() {
     if (vShaderCompiled != GL_TRUE) {
         printf("Unable to compile vertex shader %d!\n", vertexShader);
         printShaderLog(vertexShader);
-        return false;
+        return 0;
     }
 
     //Attach vertex shader to program
-    glAttachShader(gProgramID, vertexShader);
+    glAttachShader(program, vertexShader);
 
     //Create fragment shader
     GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
 
-    //Get fragment source
-    const GLchar* fragmentShaderSource[] = {
-            "#version 140\nout vec4 LFragment; void main() { LFragment = vec4( 1.0, 1.0, 1.0, 1.0 ); }"
-    };
-
     //Set fragment source
-    glShaderSource(fragmentShader, 1, fragmentShaderSource, NULL);
+    glShaderSource(fragmentShader, 1, &fragmentSource, NULL);
 
     //Compile fragment source
     glCompileShader(fragmentShader);
@@ -200,21 +200,107 @@ bool Game::initGL() {
     if (fShaderCompiled != GL_TRUE) {
         printf("Unable to compile fragment shader %d!\n", fragmentShader);
         printShaderLog(fragmentShader);
-        return false;
+        return 0;
     }
 
     //Attach fragment shader to program
-    glAttachShader(gProgramID, fragmentShader);
+    glAttachShader(program, fragmentShader);
 
     //Link program
-    glLinkProgram(gProgramID);
+    glLinkProgram(program);
 
     //Check for errors
     GLint programSuccess = GL_TRUE;
-    glGetProgramiv(gProgramID, GL_LINK_STATUS, &programSuccess);
+    glGetProgramiv(program, GL_LINK_STATUS, &programSuccess);
     if (programSuccess != GL_TRUE) {
-        printf("Error linking program %d!\n", gProgramID);
-        printProgramLog(gProgramID);
+        printf("Error linking program %d!\n", program);
+        printProgramLog(program);
+        return 0;
+    }
+
+    return program;
+}
+
+bool Game::initGL() {
+    //Get vertex source
+    const GLchar* vertexShaderSource =
+            "#version 140\n"
+            "in vec2 LVertexPos2D;\n"
+            "in vec2 LTexCoord;\n"
+            "in vec4 LVertexColor;\n"
+            "uniform mat3 LProjection;\n"
+            "out vec2 texCoord;\n"
+            "out vec4 color;\n"
+            "void main() {\n"
+            "\t//Process vertex, positions are in pixels\n"
+            "\ttexCoord = LTexCoord;\n"
+            "\tcolor = LVertexColor;\n"
+            "\tgl_Position = vec4((LProjection * vec3(LVertexPos2D, 1.0)).xy, 0.0, 1.0);\n"
+            "}";
+
+    //Get fragment source
+    const GLchar* fragmentShaderSource =
+            "#version 140\n"
+            "in vec2 texCoord;\n"
+            "in vec4 color;\n"
+            "uniform sampler2D LTexture;\n"
+            "uniform bool LTextured;\n"
+            "uniform bool LDistanceField;\n"
+            "out vec4 LFragment;\n"
+            "void main() {\n"
+            "\t//Glyph coverage or distance is stored in the red channel of the atlas\n"
+            "\tfloat sampled = texture(LTexture, texCoord).r;\n"
+            "\t//Distance fields blend over about one screen pixel around the outline at 0.5, at any scale\n"
+            "\tfloat smoothing = max(fwidth(sampled) * 0.5, 0.001);\n"
+            "\t//Circles are quads with texture coordinates from -1 to 1, cut the corners off\n"
+            "\tif (!LTextured && dot(texCoord, texCoord) > 1.0) discard;\n"
+            "\tfloat coverage = !LTextured ? 1.0\n"
+            "\t\t: LDistanceField ? smoothstep(0.5 - smoothing, 0.5 + smoothing, sampled) : sampled;\n"
+            "\tLFragment = vec4(color.rgb, color.a * coverage);\n"
+            "}";
+
+    //Bricks are instances of a unit quad, placed and colored from the per brick rectangle and hits
+    const GLchar* brickVertexShaderSource =
+            "#version 140\n"
+            "in vec2 LCorner;\n"
+            "in vec4 LRect;\n"
+            "in float LHits;\n"
+            "uniform mat3 LProjection;\n"
+            "uniform vec4 LHitColors[10];\n"
+            "out vec4 color;\n"
+            "void main() {\n"
+            "\tcolor = LHitColors[clamp(int(LHits), 0, 9)];\n"
+            "\t//Bricks without a color collapse to a point and produce no fragments\n"
+            "\tvec2 size = color.a > 0.0 ? LRect.zw : vec2(0.0);\n"
+            "\tvec2 pos = LRect.xy + LCorner * size;\n"
+            "\tgl_Position = vec4((LProjection * vec3(pos, 1.0)).xy, 0.0, 1.0);\n"
+            "}";
+
+    const GLchar* brickFragmentShaderSource =
+            "#version 140\n"
+            "in vec4 color;\n"
+            "out vec4 LFragment;\n"
+            "void main() {\n"
+            "\tLFragment = color;\n"
+            "}";
+
+    gProgramID = linkProgram(vertexShaderSource, fragmentShaderSource);
+    if (gProgramID == 0) {
+        return false;
+    }
+
+    brickProgramID = linkProgram(brickVertexShaderSource, brickFragmentShaderSource);
+    if (brickProgramID == 0) {
+        return false;
+    }
+
+    if (!spriteBatch.init(gProgramID, SCREEN_WIDTH, SCREEN_HEIGHT)) {
+        printf("Unable to create sprite batch!\n");
+        return false;
+    }
+
+    if (!brickRenderer.init(brickProgramID, SCREEN_WIDTH, SCREEN_HEIGHT)) {
+        printf("Unable to create brick renderer!\n");
         return false;
     }
 
@@ -250,21 +336,11 @@ bool Game::loadMedia() {
         return false;
     }
 
-    FT_Library ft;
-    if (FT_Init_FreeType(&ft))
-    {
-        std::cout << "ERROR::FREETYPE: Could not init FreeType Library" << std::endl;
-        return false;
-    }
-
-    ResourceManager *rm = ResourceManager::getInstance();
-    if (!rm->loadFont(ft, "Assets/SGK100.ttf")) {
+    if (!resources.loadFont("Assets/SGK100.ttf", FONT_SPREAD)) {
         printf("Font Failed to Load\n");
         return false;
     }
 
-    FT_Done_FreeType(ft);
-
     glClearColor(0.f, 0.f, 0.f, 1.f);
 
     printf("Media Success\n");
@@ -273,252 +349,183 @@ bool Game::loadMedia() {
 
 
 void Game::handleKey(SDL_Keycode key, bool down) {
-    ResourceManager * rm = ResourceManager::getInstance();
-    rm->updateKey(key, down);
+    updateKey(key, down);
 
-    if (rm->menu) {
-        if (rm->getKey(SDLK_a) && down) {
-            rm->menuIncrement(-1);
+    if (menu) {
+        if (getKey(SDLK_a) && down) {
+            menuIncrement(-1);
         }
 
-        if (rm->getKey(SDLK_d) && down) {
-            rm->menuIncrement(1);
+        if (getKey(SDLK_d) && down) {
+            menuIncrement(1);
         }
 
-        if (rm->getKey(SDLK_RETURN) && down) {
-            rm->menuFunction();
+        if (getKey(SDLK_RETURN) && down) {
+            menuFunction();
+            world.loadLevelLayout(world.levels.at(world.levelId));
+            brickRenderer.load(world);
+            if (!recordPath.empty()) {
+                replay.begin(world, 0);
+                recording = true;
+            }
         }
     }
 }
 
-void Game::input() {
-    ResourceManager * rm = ResourceManager::getInstance();
-    if (rm->getKey(SDLK_a)) {
-        rm->player->vel.x -= PADDLE_SPEED;
-    }
-
-    if (rm->getKey(SDLK_d)) {
-        rm->player->vel.x += PADDLE_SPEED;
+void Game::updateKey(SDL_Keycode key, bool state) {
+    auto it = keyState.find(key);
+    if (it != keyState.end()) {
+        it->second = state;
+    } else {
+        keyState.insert({key, state});
     }
+}
 
-    if (rm->getKey(SDLK_q)) {
-        quit = true;
+bool Game::getKey(SDL_Keycode key) {
+    auto it = keyState.find(key);
+    if (it != keyState.end()) {
+        return it->second;
     }
+    return false;
+}
 
-    if (rm->getKey(SDLK_SPACE) && rm->ballCaptured) {
-        rm->ball->vel = rm->shootVector + rm->player->vel;
-        rm->ballCaptured = false;
+void Game::menuIncrement(int i) {
+    menuIndex += i;
+    if (menuIndex < 0) {
+        menuIndex = resources.menuOptions.size() - 1;
+    } else if (menuIndex > resources.menuOptions.size() - 1) {
+        menuIndex = 0;
     }
 }
 
+void Game::menuFunction() {
+    resources.selectLanguage(menuIndex);
+    menu = false;
+}
 
-void Game::update() {
-    ResourceManager * rm = ResourceManager::getInstance();
-
-    if (rm->pauseTimer > 0 && !rm->end) {
-        rm->pauseTimer -= (float) SCREEN_TICKS_PER_FRAME / 1000.0f;
-        return;
-    }
+void Game::input() {
+    if (replaying) {
+        if (replayTick < replay.ticks()) {
+            worldInput = replay.input(replayTick++);
+        } else {
+            printf("Replay finished after %d ticks\n", replayTick);
+            replaying = false;
+            quit = true;
+        }
 
-    if (rm->menu) {
+        if (getKey(SDLK_q)) {
+            quit = true;
+        }
         return;
     }
 
-    if (rm->ball->pos.y < rm->player->pos.y - rm->player->height/2) {
-        rm->playerLives -= 1;
-        rm->ballCaptured = true;
+    if (autopilot) {
+        worldInput = pilot.next(world);
+    } else {
+        worldInput.left = getKey(SDLK_a);
+        worldInput.right = getKey(SDLK_d);
+        worldInput.shoot = getKey(SDLK_SPACE);
     }
 
-    if (rm->ballCaptured) {
-        rm->ball->pos = rm->player->pos + Vector3D(0, 10, 0);
-        rm->ball->vel.x = 0;
-        rm->ball->vel.y = 0;
-        rm->ball->vel.z = 0;
+    if (getKey(SDLK_q)) {
+        quit = true;
     }
+}
 
-    for (Entity * entity : rm->entities) {
-        entity->vel *= entity->drag;
-
-        if (Magnitude(entity->vel) > MAX_SPEED) {
-            entity->vel = Normalize(entity->vel) * MAX_SPEED;
-        }
-
-        entity->f_pos = entity->pos + entity->vel;
-
-        Vector3D* normal = NULL;
-        if (entity->shapeId == 0) {
-            if (entity->f_pos.x + entity->width / 2.0f > (float) Game::SCREEN_WIDTH) {
-                entity->f_pos.x = (float) Game::SCREEN_WIDTH - entity->width / 2.0f;
-                normal = new Vector3D(-1, 0, 0);
-            }
-
-            if (entity->f_pos.x - entity->width / 2.0f  < 0) {
-                entity->f_pos.x = entity->width / 2.0f;
-                normal = new Vector3D(1, 0, 0);
-            }
-
-            if (entity->f_pos.y + entity->height > (float) Game::SCREEN_HEIGHT) {
-                entity->f_pos.y = (float) Game::SCREEN_HEIGHT - entity->height;
-                normal = new Vector3D(0, -1, 0);
-            }
-
-            if (entity->f_pos.y - entity->height / 2.0f  < 0) {
-                entity->f_pos.y = entity->height / 2.0f;
-                normal = new Vector3D(0, 1, 0);
-            }
-        } else {
-            if (entity->f_pos.x + entity->radius > (float) Game::SCREEN_WIDTH) {
-                entity->f_pos.x = (float) Game::SCREEN_WIDTH - entity->radius;
-                normal = new Vector3D(-1, 0, 0);
-            }
-
-            if (entity->f_pos.x - entity->radius < 0) {
-                entity->f_pos.x = entity->radius;
-                normal = new Vector3D(1, 0, 0);
-            }
-
-            if (entity->f_pos.y + entity->radius > (float) Game::SCREEN_HEIGHT) {
-                entity->f_pos.y = (float) Game::SCREEN_HEIGHT - entity->radius;
-                normal = new Vector3D(0, -1, 0);
-            }
-
-            if (entity->f_pos.y - entity->radius < 0) {
-                entity->f_pos.y = entity->radius;
-                normal = new Vector3D(0, 1, 0);
-            }
-        }
-
-        if (normal != NULL) {
-            if (entity->reflects) {
-                entity->vel -= Project(entity->vel, *normal) * 2;
-            } else {
-                entity->vel -= Project(entity->vel, *normal);
-            }
-        }
+void Game::update() {
+    if (menu) {
+        return;
     }
 
-    for (int i = 0; i < rm->entities.size(); ++i) {
-        Entity * a = rm->entities.at(i);
-
-        for (int j = i; j < rm->entities.size(); ++j) {
-            Entity * b = rm->entities.at(j);
-
-            if (a->shapeId != b->shapeId && a->active && b->active) {
-                Entity * rect = a;
-                Entity * ball = b;
-                if (b->shapeId == 0) {
-                    rect = b;
-                    ball = a;
-                }
-
-                Vector3D topLeft = rect->f_pos + Vector3D(-rect->width / 2.0f, rect->height / 2.0f, 0);
-                Vector3D topRight = rect->f_pos + Vector3D(rect->width / 2.0f, rect->height / 2.0f, 0);
-                Vector3D bottomRight = rect->f_pos + Vector3D(rect->width / 2.0f, -rect->height / 2.0f, 0);
-                Vector3D bottomLeft = rect->f_pos + Vector3D(-rect->width / 2.0f, -rect->height / 2.0f, 0);
-
-                Vector3D top = PointToLine(ball->f_pos, topLeft, topRight);
-                Vector3D right = PointToLine(ball->f_pos, topRight, bottomRight);
-                Vector3D bottom = PointToLine(ball->f_pos, bottomRight, bottomLeft);
-                Vector3D left = PointToLine(ball->f_pos, bottomLeft, topLeft);
-
-                Vector3D points[] = {top, right, bottom, left};
-
-                float min = -1;
-                Vector3D closest = Vector3D(0, 0, 0);
-                for (const Vector3D& point : points) {
-                    float val = MagnitudeSqr(point - ball->f_pos);
-                    if (min == -1 || val < min) {
-                        min = val;
-                        closest.x = point.x;
-                        closest.y = point.y;
-                    }
-                }
-
-                if (sqrtf(min) < ball->radius && !rm->ballCaptured) {
-                    rm->playSound("hit");
-                    Vector3D toBall = ball->f_pos - closest;
-                    Vector3D normal = Normalize(toBall);
-
-                    ball->f_pos = closest + normal * (ball->radius * 1.1f);
-
-                    if (rect->typeId == 0) {
-                        normal = Normalize(ball->f_pos - (rect->f_pos + Vector3D(0, -rect->height * 10, 0)));
-                    }
-
-                    if (Dot(normal, ball->vel) < 0) {
-                        ball->vel -= Project(ball->vel, normal) * 2;
-                    } else {
-                        ball->vel += (normal * Magnitude(rect->vel));
-                    }
-                    ball->vel += rect->vel * 0.5;
-
-                    if (rect->typeId == 2) {
-                        rm->score += rect->hits;
-                        rect->hits -= 1;
-                        if (rect->hits == 0) {
-                            rect->active = false;
-                        }
-                    }
-                }
-            }
-        }
-    }
+    world.step(worldInput);
+    brickRenderer.update(world);
 
-    bool bricksLeft = false;
-    for (Entity * entity : rm->entities) {
-        entity->pos = entity->f_pos;
-        if (entity->typeId == 2 && entity->active && entity->hits > 0) {
-            bricksLeft = true;
-        }
+    if (recording) {
+        replay.record(worldInput, world);
     }
 
+    hashLog.tickDone(world);
 
-
-    if (!bricksLeft) {
-        rm->levelUpdate(true);
+    if (replaying && !replay.check(replayTick - 1, world)) {
+        printf("Replay diverged at tick %d\n", replayTick - 1);
+        replaying = false;
+        quit = true;
     }
 
-    if (rm->playerLives == 0) {
-        rm->levelUpdate(false);
+    // one voice per contact so simultaneous hits layer, the cap keeps a multi-ball tick from flooding the
+    // command queue, the pool steals the oldest voices beyond that
+    Clip *hit = resources.getSound("hit");
+    int hitVoices = world.events.hits < MAX_HIT_VOICES ? world.events.hits : MAX_HIT_VOICES;
+    for (int i = 0; i < hitVoices; ++i) {
+        audio.play(hit);
     }
 }
 
-void Game::render() {
+void Game::render(float alpha) {
     glClear(GL_COLOR_BUFFER_BIT);
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glLoadIdentity();
-    glColor3f(1.0f, 1.0f, 1.0f);
-
 
-
-    ResourceManager * rm = ResourceManager::getInstance();
-
-    if (rm->pauseTimer > 0) {
-        rm->drawText(rm->pauseText, Vector3D((float) SCREEN_WIDTH / 2.0f, (float) SCREEN_HEIGHT/2.0f, 0), 3.0f, 1);
-    } else if (rm->menu) {
-        int idx = 0;
-        int div = SCREEN_WIDTH / rm->menuOptions.size();
-        for (std::string option : rm->menuOptions){
-            float scale = (idx == rm->menuIndex) ? 2.0f : 1.0f;
-            rm->drawText(option, Vector3D(div/2 + div * idx, (float) SCREEN_HEIGHT/2.0f, 0), scale, 1);
-            ++idx;
+    spriteBatch.begin();
+
+    // layouts are only rebuilt when the shown text changes, a steady frame just copies their quads
+    FontAtlas &font = resources.getFont();
+    if (world.pauseTimer > 0) {
+        pauseText.set(font, resources.getText(pauseMessage(world.pauseReason)),
+                      Vector3D((float) SCREEN_WIDTH / 2.0f, (float) SCREEN_HEIGHT/2.0f, 0), 3.0f, 1);
+        resources.drawText(spriteBatch, pauseText);
+    } else if (menu) {
+        menuText.resize(resources.menuOptions.size());
+        int div = SCREEN_WIDTH / resources.menuOptions.size();
+        for (int idx = 0; idx < (int) resources.menuOptions.size(); ++idx) {
+            float scale = (idx == menuIndex) ? 2.0f : 1.0f;
+            menuText[idx].set(font, resources.menuOptions[idx],
+                              Vector3D(div/2 + div * idx, (float) SCREEN_HEIGHT/2.0f, 0), scale, 1);
+            resources.drawText(spriteBatch, menuText[idx]);
         }
 
     } else {
-        for (Entity *entity : rm->entities) {
-            ResourceManager::drawEntity(entity);
+        // one instanced draw before the batch, so the balls end up on top of the bricks
+        brickRenderer.draw();
+        for (int i = 0; i < world.entities.size(); ++i) {
+            if (world.entities.typeId[i] != 2) {
+                ResourceManager::drawEntity(spriteBatch, world.entities, i, alpha);
+            }
         }
 
-        glColor3f(1.0f, 1.0f, 1.0f);
+        scoreText.set(font, resources.getText("score"), world.score,
+                      Vector3D(20, (float) SCREEN_HEIGHT - 40.0f, 0), 1.0f, 0);
+        levelText.set(font, resources.getText("level"), world.levelId + 1,
+                      Vector3D((float) SCREEN_WIDTH / 2.0f, (float) SCREEN_HEIGHT - 40.0f, 0), 1.0f, 1);
+        livesText.set(font, resources.getText("lives"), world.playerLives,
+                      Vector3D((float) SCREEN_WIDTH - 20, (float) SCREEN_HEIGHT - 40.0f, 0), 1.0f, 2);
+        resources.drawText(spriteBatch, scoreText);
+        resources.drawText(spriteBatch, levelText);
+        resources.drawText(spriteBatch, livesText);
+    }
 
-        rm->drawText(rm->getText("score") + " " + std::to_string(rm->score),
-                     Vector3D(20, (float) SCREEN_HEIGHT - 40.0f, 0), 1.0f, 0);
-        rm->drawText(rm->getText("level") + " " + std::to_string(rm->levelId + 1),
-                     Vector3D((float) SCREEN_WIDTH / 2.0f, (float) SCREEN_HEIGHT - 40.0f, 0), 1.0f, 1);
-        rm->drawText(rm->getText("lives") + " " + std::to_string(rm->playerLives),
-                     Vector3D((float) SCREEN_WIDTH - 20, (float) SCREEN_HEIGHT - 40.0f, 0), 1.0f, 2);
+    spriteBatch.flush();
+}
+
+float Game::tick() {
+    Uint32 now = fpsTimer.getTicks();
+    float frameTime = (float) (now - lastTickTime) / 1000.0f;
+    lastTickTime = now;
+
+    if (frameTime > MAX_FRAME_TIME) {
+        frameTime = MAX_FRAME_TIME;
+    }
+
+    float tickTime = 1.0f / (float) TICK_RATE;
+    accumulator += frameTime;
+
+    while (accumulator >= tickTime) {
+        input();
+        update();
+        accumulator -= tickTime;
     }
+
+    return accumulator / tickTime;
 }
 
 void Game::sync() {
@@ -538,12 +545,41 @@ void Game::sync() {
 void Game::run() {
     printf("Running\n");
 
-    ResourceManager * rm = ResourceManager::getInstance();
-    rm->startUp();
+    if (!resources.startUp()) {
+        printf("Failed to load resources\n");
+        close();
+        return;
+    }
+
+    Clip *background = resources.getSound("background");
+    audio.loop(background, true);
+    audio.play(background);
+    audio.open();
+
+    world.config.screenWidth = SCREEN_WIDTH;
+    world.config.screenHeight = SCREEN_HEIGHT;
+    world.config.tickRate = TICK_RATE;
+    world.config.multiBall = multiBall;
+    world.levels = resources.getLevels();
+
+    if (!replayPath.empty()) {
+        // skip the menu and play the recorded ticks at the recorded tick rate
+        if (!replay.load(replayPath) || !replay.setUp(world)) {
+            close();
+            return;
+        }
+        TICK_RATE = world.config.tickRate;
+        brickRenderer.load(world);
+        resources.selectLanguage(0);
+        replaying = true;
+    } else {
+        world.startUp();
+    }
 
     fpsTimer.start();
-    rm->menu = true;
-    rm->ballCaptured = true;
+    lastTickTime = fpsTimer.getTicks();
+    menu = !replaying;
+    world.ballCaptured = true;
 
     //Event handler
     SDL_Event e;
@@ -571,9 +607,7 @@ void Game::run() {
             }
         }
 
-        input();
-        update();
-        render();
+        render(tick());
 
         //Update screen
         SDL_GL_SwapWindow(gWindow);
@@ -588,11 +622,20 @@ void Game::run() {
 }
 
 void Game::close() {
-    ResourceManager *rm = ResourceManager::getInstance();
-    rm->shutDown();
+    if (recording && replay.save(recordPath)) {
+        printf("Recorded %d ticks to %s\n", replay.ticks(), recordPath.c_str());
+    }
+
+    // voices point into the clips, stop the callback before freeing them
+    audio.close();
+    resources.shutDown();
+
+    spriteBatch.shutDown();
+    brickRenderer.shutDown();
 
-    //Deallocate program
+    //Deallocate programs
     glDeleteProgram(gProgramID);
+    glDeleteProgram(brickProgramID);
 
     //Destroy window
     SDL_DestroyWindow(gWindow);
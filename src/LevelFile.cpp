@@ -0,0 +1,337 @@
+//
+// Created by jibbo on 3/26/21.
+//
+
+#include <LevelFile.h>
+#include <World.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <streambuf>
+
+#if defined(_WIN32)
+    #define WIN32_LEAN_AND_MEAN
+    #include <windows.h>
+    #include <sys/types.h>
+    #include <sys/stat.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+/*!
+ * Size of the hit count block, padded so the rectangles that follow are aligned.
+ */
+static size_t paddedCells(uint32_t cells) {
+    return ((size_t) cells + 3u) & ~(size_t) 3u;
+}
+
+bool LevelLayout::rectsMatch(const WorldConfig &config) const {
+    return rects != nullptr && header != nullptr
+           && header->screenWidth == config.screenWidth
+           && header->screenHeight == config.screenHeight
+           && header->brickTopOffset == config.brickTopOffset
+           && header->brickHeight == config.brickHeight
+           && header->brickSpacing == config.brickSpacing;
+}
+
+void LevelText::parse(const std::string &str) {
+    rowCols.clear();
+    hits.clear();
+    bricks = 0;
+
+    size_t start = 0;
+    while (start < str.size()) {
+        size_t end = str.find('\n', start);
+        if (end == std::string::npos) {
+            end = str.size();
+        }
+
+        uint32_t cols = 0;
+        for (size_t i = start; i < end; ++i) {
+            char c = str[i];
+            if (c == ' ' || c == '\r') {
+                continue;
+            }
+            uint8_t n = (c >= '0' && c <= '9') ? (uint8_t) (c - '0') : 0;
+            hits.push_back(n);
+            bricks += n > 0;
+            ++cols;
+        }
+        rowCols.push_back(cols);
+
+        start = end + 1;
+    }
+}
+
+LevelLayout LevelText::layout() const {
+    LevelLayout l;
+    l.rows = (uint32_t) rowCols.size();
+    l.cells = (uint32_t) hits.size();
+    l.bricks = bricks;
+    l.rowCols = rowCols.data();
+    l.hits = hits.data();
+    return l;
+}
+
+bool LevelFile::open(const std::string &path) {
+    close();
+
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        printf("Could not open level file: %s\n", path.c_str());
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    GetFileSizeEx(file, &fileSize);
+    size = (size_t) fileSize.QuadPart;
+    HANDLE mapping = size > 0 ? CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL) : NULL;
+    CloseHandle(file);
+    if (mapping == NULL) {
+        printf("Could not map level file: %s\n", path.c_str());
+        size = 0;
+        return false;
+    }
+    data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        printf("Could not open level file: %s\n", path.c_str());
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        printf("Could not map level file: %s\n", path.c_str());
+        ::close(fd);
+        return false;
+    }
+    size = (size_t) st.st_size;
+    data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // the mapping keeps its own reference to the file
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        data = nullptr;
+    }
+#endif
+
+    if (data == nullptr) {
+        printf("Could not map level file: %s\n", path.c_str());
+        size = 0;
+        return false;
+    }
+
+    const unsigned char *bytes = (const unsigned char *) data;
+    const LevelFileHeader *header = (const LevelFileHeader *) bytes;
+    if (size < sizeof(LevelFileHeader) || memcmp(header->magic, "BJLV", 4) != 0
+        || header->version != LEVEL_FILE_VERSION) {
+        printf("Not a compiled level file or wrong version: %s\n", path.c_str());
+        close();
+        return false;
+    }
+
+    // worlds index hits by the row counts and allocate bricks entities, so both counts have to be right
+    // before anything trusts them, a truncated or edited file would otherwise read and write out of bounds
+    size_t rowsOffset = sizeof(LevelFileHeader);
+    size_t hitsOffset = rowsOffset + (size_t) header->rows * sizeof(uint32_t);
+    if (size < hitsOffset) {
+        printf("Truncated level file: %s\n", path.c_str());
+        close();
+        return false;
+    }
+
+    const uint32_t *rowCols = (const uint32_t *) (bytes + rowsOffset);
+    uint64_t cells = 0;
+    for (uint32_t row = 0; row < header->rows; ++row) {
+        cells += rowCols[row];
+    }
+    if (cells != header->cells) {
+        printf("Row lengths don't add up to %u cells: %s\n", header->cells, path.c_str());
+        close();
+        return false;
+    }
+
+    size_t rectsOffset = hitsOffset + paddedCells(header->cells);
+    if (size < rectsOffset) {
+        printf("Truncated level file: %s\n", path.c_str());
+        close();
+        return false;
+    }
+
+    const uint8_t *hits = bytes + hitsOffset;
+    uint32_t bricks = 0;
+    for (uint32_t cell = 0; cell < header->cells; ++cell) {
+        bricks += hits[cell] > 0;
+    }
+    if (bricks != header->bricks) {
+        printf("Level file has %u bricks, header says %u: %s\n", bricks, header->bricks, path.c_str());
+        close();
+        return false;
+    }
+
+    size_t expected = rectsOffset;
+    if (header->flags & LEVEL_HAS_RECTS) {
+        expected += (size_t) bricks * 4 * sizeof(float);
+    }
+    if (size < expected) {
+        printf("Truncated level file: %s\n", path.c_str());
+        close();
+        return false;
+    }
+
+    view.rows = header->rows;
+    view.cells = header->cells;
+    view.bricks = bricks;
+    view.rowCols = rowCols;
+    view.hits = hits;
+    view.rects = (header->flags & LEVEL_HAS_RECTS) ? (const float *) (bytes + rectsOffset) : nullptr;
+    view.header = header;
+    return true;
+}
+
+void LevelFile::close() {
+    if (data != nullptr) {
+#if defined(_WIN32)
+        UnmapViewOfFile(data);
+#else
+        munmap(data, size);
+#endif
+    }
+    data = nullptr;
+    size = 0;
+    view = LevelLayout();
+}
+
+bool isCompiledLevel(const std::string &path) {
+    static const std::string compiledExtension = ".bjl";
+    return path.size() >= compiledExtension.size()
+           && path.compare(path.size() - compiledExtension.size(), compiledExtension.size(), compiledExtension) == 0;
+}
+
+/*!
+ * Last modification time of a file.
+ * @return false if the file doesn't exist
+ */
+static bool modifiedTime(const std::string &path, time_t &time) {
+#if defined(_WIN32)
+    struct _stat st;
+    if (_stat(path.c_str(), &st) != 0) {
+        return false;
+    }
+#else
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) {
+        return false;
+    }
+#endif
+    time = st.st_mtime;
+    return true;
+}
+
+bool LevelLibrary::loadNewest(const std::string &compiledPath, const std::string &textPath) {
+    time_t compiledTime = 0;
+    time_t textTime = 0;
+    bool hasText = modifiedTime(textPath, textTime);
+    if (modifiedTime(compiledPath, compiledTime) && (!hasText || compiledTime >= textTime)) {
+        if (load(compiledPath)) {
+            return true;
+        }
+        // built by another version of the format, the text still works
+        if (!hasText) {
+            return false;
+        }
+        printf("Using %s instead\n", textPath.c_str());
+    }
+    return load(textPath);
+}
+
+bool LevelLibrary::load(const std::string &path) {
+    if (isCompiledLevel(path)) {
+        std::unique_ptr<LevelFile> file(new LevelFile());
+        if (!file->open(path)) {
+            return false;
+        }
+        views.push_back(file->layout());
+        files.push_back(std::move(file));
+        return true;
+    }
+
+    std::ifstream t(path);
+    if (!t) {
+        printf("Could not open level file: %s\n", path.c_str());
+        return false;
+    }
+    std::string str((std::istreambuf_iterator<char>(t)),std::istreambuf_iterator<char>());
+
+    std::unique_ptr<LevelText> text(new LevelText());
+    text->parse(str);
+    views.push_back(text->layout());
+    texts.push_back(std::move(text));
+    return true;
+}
+
+void LevelLibrary::clear() {
+    views.clear();
+    files.clear();
+    texts.clear();
+}
+
+bool writeLevelFile(const std::string &path, const LevelLayout &layout, const WorldConfig *rectConfig) {
+    LevelFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "BJLV", 4);
+    header.version = LEVEL_FILE_VERSION;
+    header.rows = layout.rows;
+    header.cells = layout.cells;
+    header.bricks = layout.bricks;
+
+    std::vector<float> rects;
+    if (rectConfig != nullptr) {
+        header.flags |= LEVEL_HAS_RECTS;
+        header.screenWidth = rectConfig->screenWidth;
+        header.screenHeight = rectConfig->screenHeight;
+        header.brickTopOffset = rectConfig->brickTopOffset;
+        header.brickHeight = rectConfig->brickHeight;
+        header.brickSpacing = rectConfig->brickSpacing;
+
+        rects.reserve((size_t) layout.bricks * 4);
+        size_t cell = 0;
+        for (uint32_t row = 0; row < layout.rows; ++row) {
+            int cols = (int) layout.rowCols[row];
+            float width = rectConfig->brickWidth(cols);
+            float y = rectConfig->brickY((int) row);
+            for (int col = 0; col < cols; ++col, ++cell) {
+                if (layout.hits[cell] > 0) {
+                    rects.push_back(rectConfig->brickX(col, width));
+                    rects.push_back(y);
+                    rects.push_back(width);
+                    rects.push_back((float) rectConfig->brickHeight);
+                }
+            }
+        }
+    }
+
+    FILE *f = fopen(path.c_str(), "wb");
+    if (f == nullptr) {
+        printf("Could not write level file: %s\n", path.c_str());
+        return false;
+    }
+
+    const uint8_t padding[4] = {0, 0, 0, 0};
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1;
+    ok = ok && fwrite(layout.rowCols, sizeof(uint32_t), layout.rows, f) == layout.rows;
+    ok = ok && fwrite(layout.hits, 1, layout.cells, f) == layout.cells;
+    size_t pad = paddedCells(layout.cells) - layout.cells;
+    ok = ok && fwrite(padding, 1, pad, f) == pad;
+    ok = ok && fwrite(rects.data(), sizeof(float), rects.size(), f) == rects.size();
+    ok = fclose(f) == 0 && ok;
+
+    if (!ok) {
+        printf("Could not write level file: %s\n", path.c_str());
+    }
+    return ok;
+}
@@ -0,0 +1,145 @@
+//
+// Created by jibbo on 3/31/21.
+//
+
+#include <Replay.h>
+#include <StateHash.h>
+#include <cstdio>
+#include <cstring>
+
+/*!
+ * Size of the input block, padded so the hashes that follow are aligned.
+ */
+static size_t paddedTicks(uint32_t ticks) {
+    return (ticks + 7u) & ~(size_t) 7u;
+}
+
+uint64_t hashLevels(const std::vector<LevelLayout> &levels) {
+    uint64_t h = hashBytes(nullptr, 0);
+    for (const LevelLayout &l : levels) {
+        h = hashBytes(&l.rows, sizeof(l.rows), h);
+        h = hashBytes(l.rowCols, l.rows * sizeof(uint32_t), h);
+        h = hashBytes(l.hits, l.cells, h);
+    }
+    return h;
+}
+
+Replay::Replay() {
+    memset(&header, 0, sizeof(header));
+}
+
+void Replay::begin(const World &world, uint32_t seed) {
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "BJRP", 4);
+    header.version = REPLAY_FILE_VERSION;
+    header.flags = REPLAY_HAS_HASHES;
+    header.seed = seed;
+    header.levelId = world.levelId;
+    header.levelCount = (uint32_t) world.levels.size();
+    header.tickRate = world.config.tickRate;
+    header.screenWidth = world.config.screenWidth;
+    header.screenHeight = world.config.screenHeight;
+    header.multiBall = world.config.multiBall;
+    header.levelHash = hashLevels(world.levels);
+
+    inputs.clear();
+    hashes.clear();
+}
+
+void Replay::record(const WorldInput &in, const World &world) {
+    uint8_t bits = 0;
+    bits |= in.left ? REPLAY_LEFT : 0;
+    bits |= in.right ? REPLAY_RIGHT : 0;
+    bits |= in.shoot ? REPLAY_SHOOT : 0;
+    inputs.push_back(bits);
+
+    if (header.flags & REPLAY_HAS_HASHES) {
+        hashes.push_back(hashWorldState(world));
+    }
+    header.ticks = (uint32_t) inputs.size();
+}
+
+WorldInput Replay::input(int tick) const {
+    WorldInput in;
+    uint8_t bits = inputs.at(tick);
+    in.left = (bits & REPLAY_LEFT) != 0;
+    in.right = (bits & REPLAY_RIGHT) != 0;
+    in.shoot = (bits & REPLAY_SHOOT) != 0;
+    return in;
+}
+
+bool Replay::check(int tick, const World &world) const {
+    if (hashes.empty()) {
+        return true;
+    }
+    return hashes.at(tick) == hashWorldState(world);
+}
+
+bool Replay::setUp(World &world) const {
+    if ((uint32_t) world.levels.size() != header.levelCount || hashLevels(world.levels) != header.levelHash
+        || header.levelId < 0 || header.levelId >= (int32_t) header.levelCount) {
+        printf("Replay was recorded on different levels\n");
+        return false;
+    }
+
+    world.config.tickRate = header.tickRate;
+    world.config.screenWidth = header.screenWidth;
+    world.config.screenHeight = header.screenHeight;
+    world.config.multiBall = header.multiBall;
+    world.startUp();
+    world.levelId = header.levelId;
+    world.loadLevelLayout(world.levels.at(world.levelId));
+    return true;
+}
+
+bool Replay::save(const std::string &path) const {
+    FILE *f = fopen(path.c_str(), "wb");
+    if (f == nullptr) {
+        printf("Could not write replay file: %s\n", path.c_str());
+        return false;
+    }
+
+    const uint8_t padding[8] = {0};
+    size_t pad = paddedTicks(header.ticks) - header.ticks;
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1;
+    ok = ok && fwrite(inputs.data(), 1, inputs.size(), f) == inputs.size();
+    ok = ok && fwrite(padding, 1, pad, f) == pad;
+    ok = ok && fwrite(hashes.data(), sizeof(uint64_t), hashes.size(), f) == hashes.size();
+    ok = fclose(f) == 0 && ok;
+
+    if (!ok) {
+        printf("Could not write replay file: %s\n", path.c_str());
+    }
+    return ok;
+}
+
+bool Replay::load(const std::string &path) {
+    FILE *f = fopen(path.c_str(), "rb");
+    if (f == nullptr) {
+        printf("Could not open replay file: %s\n", path.c_str());
+        return false;
+    }
+
+    ReplayHeader h;
+    if (fread(&h, sizeof(h), 1, f) != 1 || memcmp(h.magic, "BJRP", 4) != 0 || h.version != REPLAY_FILE_VERSION) {
+        printf("Not a replay file or wrong version: %s\n", path.c_str());
+        fclose(f);
+        return false;
+    }
+
+    std::vector<uint8_t> in(paddedTicks(h.ticks));
+    std::vector<uint64_t> hs((h.flags & REPLAY_HAS_HASHES) ? h.ticks : 0);
+    bool ok = fread(in.data(), 1, in.size(), f) == in.size();
+    ok = ok && fread(hs.data(), sizeof(uint64_t), hs.size(), f) == hs.size();
+    fclose(f);
+    if (!ok) {
+        printf("Truncated replay file: %s\n", path.c_str());
+        return false;
+    }
+
+    in.resize(h.ticks);
+    header = h;
+    inputs.swap(in);
+    hashes.swap(hs);
+    return true;
+}
@@ -0,0 +1,264 @@
+//
+// Created by jibbo on 4/3/21.
+//
+
+#include <SoftRaster.h>
+#include <Lanes.h>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+/*!
+ * Fill n 32 bit pixels with a value, the vector backends store a whole register per iteration.
+ */
+static void fill32(uint32_t *dst, int n, uint32_t value) {
+    int i = 0;
+#if defined(BREAKJOE_LANES_AVX512) || defined(BREAKJOE_LANES_AVX2)
+    __m256i v = _mm256_set1_epi32((int) value);
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_si256((__m256i *) (dst + i), v);
+    }
+#elif defined(BREAKJOE_LANES_SSE2)
+    __m128i v = _mm_set1_epi32((int) value);
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_si128((__m128i *) (dst + i), v);
+    }
+#endif
+    for (; i < n; ++i) {
+        dst[i] = value;
+    }
+}
+
+/*!
+ * First pixel whose center is at or right of an edge.
+ */
+static int pixelEdge(float edge) {
+    return (int) ceilf(edge - 0.5f);
+}
+
+static uint8_t toByte(float v) {
+    if (v <= 0) {
+        return 0;
+    }
+    if (v >= 1) {
+        return 255;
+    }
+    return (uint8_t) (v * 255.0f + 0.5f);
+}
+
+bool SoftRaster::init(int width, int height, int channels, int screenWidth, int screenHeight) {
+    if (width <= 0 || height <= 0) {
+        printf("SoftRaster: invalid size %dx%d\n", width, height);
+        return false;
+    }
+    storage.assign((size_t) width * height * channels, 0);
+    return setTarget(storage.data(), width, height, channels, screenWidth, screenHeight);
+}
+
+bool SoftRaster::setTarget(uint8_t *target, int width, int height, int channels, int screenWidth,
+                           int screenHeight) {
+    if (target == nullptr || width <= 0 || height <= 0 || screenWidth <= 0 || screenHeight <= 0) {
+        printf("SoftRaster: invalid target %dx%d of a %dx%d screen\n", width, height, screenWidth, screenHeight);
+        return false;
+    }
+    if (channels != 1 && channels != 4) {
+        printf("SoftRaster: %d channels, only 1 (gray) and 4 (RGBA) are supported\n", channels);
+        return false;
+    }
+
+    pixels = target;
+    w = width;
+    h = height;
+    c = channels;
+    xScale = (float) width / (float) screenWidth;
+    yScale = (float) height / (float) screenHeight;
+    screenTop = (float) screenHeight;
+    return true;
+}
+
+void SoftRaster::clear(float r, float g, float b) {
+    uint8_t saved[4];
+    memcpy(saved, color, sizeof(color));
+    float savedAlpha = alpha;
+
+    setColor(r, g, b);
+    for (int row = 0; row < h; ++row) {
+        fillSpan(row, 0, w);
+    }
+
+    memcpy(color, saved, sizeof(color));
+    alpha = savedAlpha;
+}
+
+void SoftRaster::setColor(float r, float g, float b, float a) {
+    if (c == 1) {
+        color[0] = toByte(0.299f * r + 0.587f * g + 0.114f * b);
+    } else {
+        color[0] = toByte(r);
+        color[1] = toByte(g);
+        color[2] = toByte(b);
+        color[3] = 255;
+    }
+    alpha = a;
+}
+
+void SoftRaster::blend(uint8_t *p, int a) {
+    for (int k = 0; k < c; ++k) {
+        p[k] = (uint8_t) (p[k] + ((color[k] - p[k]) * a + 127) / 255);
+    }
+}
+
+void SoftRaster::fillSpan(int row, int x0, int x1) {
+    if (x0 < 0) x0 = 0;
+    if (x1 > w) x1 = w;
+    if (x0 >= x1) {
+        return;
+    }
+
+    uint8_t *p = pixels + ((size_t) row * w + x0) * c;
+    if (alpha >= 1.0f) {
+        if (c == 1) {
+            memset(p, color[0], (size_t) (x1 - x0));
+        } else {
+            uint32_t value;
+            memcpy(&value, color, sizeof(value));
+            fill32((uint32_t *) p, x1 - x0, value);
+        }
+        return;
+    }
+
+    int a = (int) toByte(alpha);
+    for (int x = x0; x < x1; ++x, p += c) {
+        blend(p, a);
+    }
+}
+
+void SoftRaster::drawRect(float x, float y, float width, float height) {
+    int x0 = pixelEdge((x - width / 2.0f) * xScale);
+    int x1 = pixelEdge((x + width / 2.0f) * xScale);
+    int y0 = pixelEdge((screenTop - (y + height / 2.0f)) * yScale);
+    int y1 = pixelEdge((screenTop - (y - height / 2.0f)) * yScale);
+
+    if (y0 < 0) y0 = 0;
+    if (y1 > h) y1 = h;
+    for (int row = y0; row < y1; ++row) {
+        fillSpan(row, x0, x1);
+    }
+}
+
+void SoftRaster::drawCircle(float x, float y, float radius) {
+    float cx = x * xScale;
+    float cy = (screenTop - y) * yScale;
+    float rx = radius * xScale;
+    float ry = radius * yScale;
+    if (rx <= 0 || ry <= 0) {
+        return;
+    }
+
+    int y0 = pixelEdge(cy - ry);
+    int y1 = pixelEdge(cy + ry);
+    if (y0 < 0) y0 = 0;
+    if (y1 > h) y1 = h;
+
+    for (int row = y0; row < y1; ++row) {
+        float dy = ((float) row + 0.5f - cy) / ry;
+        float squared = 1.0f - dy * dy;
+        if (squared <= 0) {
+            continue;
+        }
+        float half = rx * sqrtf(squared);
+        fillSpan(row, pixelEdge(cx - half), pixelEdge(cx + half));
+    }
+}
+
+void SoftRaster::drawQuad(float left, float bottom, float right, float top, float u0, float v0, float u1,
+                          float v1) {
+    if (font == nullptr || font->pixels.empty()) {
+        drawRect((left + right) / 2.0f, (bottom + top) / 2.0f, right - left, top - bottom);
+        return;
+    }
+
+    float bufLeft = left * xScale;
+    float bufRight = right * xScale;
+    float bufTop = (screenTop - top) * yScale;
+    float bufBottom = (screenTop - bottom) * yScale;
+    if (bufRight <= bufLeft || bufBottom <= bufTop) {
+        return;
+    }
+
+    int x0 = pixelEdge(bufLeft);
+    int x1 = pixelEdge(bufRight);
+    int y0 = pixelEdge(bufTop);
+    int y1 = pixelEdge(bufBottom);
+    if (x0 < 0) x0 = 0;
+    if (x1 > w) x1 = w;
+    if (y0 < 0) y0 = 0;
+    if (y1 > h) y1 = h;
+
+    // nearest atlas texel of every covered pixel center
+    float texelsX = (u1 - u0) * (float) font->width / (bufRight - bufLeft);
+    float texelsY = (v1 - v0) * (float) font->height / (bufBottom - bufTop);
+    int opacity = (int) toByte(alpha);
+
+    // distance field values to signed distances in buffer pixels, 0.5 is the outline
+    float fieldToPixels = (float) (2 * font->spread) / texelsX;
+
+    for (int row = y0; row < y1; ++row) {
+        int ty = (int) (v0 * (float) font->height + ((float) row + 0.5f - bufTop) * texelsY);
+        if (ty < 0 || ty >= font->height) {
+            continue;
+        }
+        const unsigned char *texels = &font->pixels[(size_t) ty * font->width];
+        uint8_t *p = pixels + ((size_t) row * w + x0) * c;
+
+        for (int x = x0; x < x1; ++x, p += c) {
+            int tx = (int) (u0 * (float) font->width + ((float) x + 0.5f - bufLeft) * texelsX);
+            if (tx < 0 || tx >= font->width) {
+                continue;
+            }
+            int coverage;
+            if (font->spread > 0) {
+                float inside = ((float) texels[tx] / 255.0f - 0.5f) * fieldToPixels + 0.5f;
+                coverage = inside <= 0 ? 0 : (inside >= 1 ? opacity : (int) (inside * (float) opacity));
+            } else {
+                coverage = texels[tx] * opacity / 255;
+            }
+            if (coverage > 0) {
+                blend(p, coverage);
+            }
+        }
+    }
+}
+
+bool SoftRaster::save(const std::string &path) const {
+    FILE *file = fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        printf("Unable to write %s\n", path.c_str());
+        return false;
+    }
+
+    fprintf(file, "%s\n%d %d\n255\n", c == 1 ? "P5" : "P6", w, h);
+
+    bool ok = true;
+    if (c == 1) {
+        ok = fwrite(pixels, 1, (size_t) w * h, file) == (size_t) w * h;
+    } else {
+        // PPM has no alpha, write the rows as RGB
+        std::vector<uint8_t> rgb((size_t) w * 3);
+        for (int row = 0; row < h && ok; ++row) {
+            const uint8_t *p = pixels + (size_t) row * w * 4;
+            for (int x = 0; x < w; ++x) {
+                rgb[x * 3] = p[x * 4];
+                rgb[x * 3 + 1] = p[x * 4 + 1];
+                rgb[x * 3 + 2] = p[x * 4 + 2];
+            }
+            ok = fwrite(rgb.data(), 1, rgb.size(), file) == rgb.size();
+        }
+    }
+
+    if (fclose(file) != 0 || !ok) {
+        printf("Unable to write %s\n", path.c_str());
+        return false;
+    }
+    return true;
+}
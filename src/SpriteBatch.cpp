@@ -0,0 +1,141 @@
+//
+// Created by jibbo on 3/20/21.
+//
+
+#include <SpriteBatch.h>
+#include <cstddef>
+#include <cstdio>
+
+bool SpriteBatch::init(GLuint programId, int width, int height) {
+    program = programId;
+
+    posLoc = glGetAttribLocation(program, "LVertexPos2D");
+    uvLoc = glGetAttribLocation(program, "LTexCoord");
+    colorLoc = glGetAttribLocation(program, "LVertexColor");
+    texturedLoc = glGetUniformLocation(program, "LTextured");
+    distanceLoc = glGetUniformLocation(program, "LDistanceField");
+    projectionLoc = glGetUniformLocation(program, "LProjection");
+    if (posLoc == -1 || uvLoc == -1 || colorLoc == -1 || projectionLoc == -1) {
+        printf("Sprite program is missing LVertexPos2D/LTexCoord/LVertexColor attributes or LProjection\n");
+        return false;
+    }
+
+    setScreenSize(width, height);
+
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &vbo);
+
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glEnableVertexAttribArray(posLoc);
+    glVertexAttribPointer(posLoc, 2, GL_FLOAT, GL_FALSE, sizeof(SpriteVertex),
+                          (const GLvoid *) offsetof(SpriteVertex, x));
+    glEnableVertexAttribArray(uvLoc);
+    glVertexAttribPointer(uvLoc, 2, GL_FLOAT, GL_FALSE, sizeof(SpriteVertex),
+                          (const GLvoid *) offsetof(SpriteVertex, u));
+    glEnableVertexAttribArray(colorLoc);
+    glVertexAttribPointer(colorLoc, 4, GL_FLOAT, GL_FALSE, sizeof(SpriteVertex),
+                          (const GLvoid *) offsetof(SpriteVertex, r));
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    return true;
+}
+
+void SpriteBatch::setScreenSize(int width, int height) {
+    // pixel (0, 0) is the bottom left corner of the screen
+    Matrix3D projection = Orthographic2D(0, (float) width, 0, (float) height);
+
+    glUseProgram(program);
+    glUniformMatrix3fv(projectionLoc, 1, GL_FALSE, &projection(0, 0));
+    glUseProgram(0);
+}
+
+void SpriteBatch::begin() {
+    vertices.clear();
+    texture = 0;
+    drawCalls = 0;
+}
+
+void SpriteBatch::setTexture(GLuint tex, bool distance) {
+    if (tex != texture || distance != distanceField) {
+        flush();
+        texture = tex;
+        distanceField = distance;
+    }
+}
+
+void SpriteBatch::drawRect(float x, float y, float w, float h) {
+    float left = x - w / 2;
+    float right = x + w / 2;
+    float top = y + h / 2;
+    float bottom = y - h / 2;
+
+    vertex(left, top);
+    vertex(right, top);
+    vertex(right, bottom);
+
+    vertex(left, top);
+    vertex(right, bottom);
+    vertex(left, bottom);
+}
+
+void SpriteBatch::drawCircle(float x, float y, float radius) {
+    float left = x - radius;
+    float right = x + radius;
+    float top = y + radius;
+    float bottom = y - radius;
+
+    vertex(left, top, -1, 1);
+    vertex(right, top, 1, 1);
+    vertex(right, bottom, 1, -1);
+
+    vertex(left, top, -1, 1);
+    vertex(right, bottom, 1, -1);
+    vertex(left, bottom, -1, -1);
+}
+
+void SpriteBatch::drawQuad(float left, float bottom, float right, float top,
+                           float u0, float v0, float u1, float v1) {
+    vertex(left, top, u0, v0);
+    vertex(right, top, u1, v0);
+    vertex(right, bottom, u1, v1);
+
+    vertex(left, top, u0, v0);
+    vertex(right, bottom, u1, v1);
+    vertex(left, bottom, u0, v1);
+}
+
+void SpriteBatch::flush() {
+    if (vertices.empty()) {
+        return;
+    }
+
+    glUseProgram(program);
+    glUniform1i(texturedLoc, texture != 0);
+    if (distanceLoc != -1) {
+        glUniform1i(distanceLoc, distanceField);
+    }
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+
+    // respecifying the whole buffer lets the driver orphan last frame's storage instead of waiting on it
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(SpriteVertex), vertices.data(), GL_STREAM_DRAW);
+    glDrawArrays(GL_TRIANGLES, 0, (GLsizei) vertices.size());
+    ++drawCalls;
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glUseProgram(0);
+
+    vertices.clear();
+}
+
+void SpriteBatch::shutDown() {
+    glDeleteBuffers(1, &vbo);
+    glDeleteVertexArrays(1, &vao);
+    vbo = 0;
+    vao = 0;
+}
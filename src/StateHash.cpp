@@ -0,0 +1,240 @@
+//
+// Created by jibbo on 3/31/21.
+//
+
+#include <StateHash.h>
+#include <World.h>
+#include <cstring>
+
+static const uint64_t PRIME1 = 0x9E3779B185EBCA87ull;
+static const uint64_t PRIME2 = 0xC2B2AE3D27D4EB4Full;
+static const uint64_t PRIME3 = 0x165667B19E3779F9ull;
+static const uint64_t PRIME4 = 0x85EBCA77C2B2AE63ull;
+static const uint64_t PRIME5 = 0x27D4EB2F165667C5ull;
+
+static const uint32_t HASH_LOG_VERSION = 1; /**<  bumped whenever the fields or the hash change */
+
+/*!
+ * Header of a state hash log, followed by STATE_FIELD_COUNT uint64 hashes per tick.
+ */
+struct StateHashLogHeader {
+    char magic[4];      /**<  "BJHL" */
+    uint32_t version;   /**<  HASH_LOG_VERSION */
+    uint32_t fields;    /**<  STATE_FIELD_COUNT */
+    uint32_t reserved;  /**<  keeps the header a multiple of 8 bytes */
+};
+
+static inline uint64_t rotl(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t read64(const unsigned char *p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint32_t read32(const unsigned char *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t round64(uint64_t acc, uint64_t input) {
+    acc += input * PRIME2;
+    acc = rotl(acc, 31);
+    return acc * PRIME1;
+}
+
+static inline uint64_t merge64(uint64_t acc, uint64_t val) {
+    acc ^= round64(0, val);
+    return acc * PRIME1 + PRIME4;
+}
+
+uint64_t hashBytes(const void *data, size_t size, uint64_t seed) {
+    const unsigned char *p = (const unsigned char *) data;
+    const unsigned char *end = p + size;
+    uint64_t h;
+
+    if (size >= 32) {
+        // four independent lanes keep the multipliers busy
+        uint64_t v1 = seed + PRIME1 + PRIME2;
+        uint64_t v2 = seed + PRIME2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - PRIME1;
+        const unsigned char *limit = end - 32;
+        do {
+            v1 = round64(v1, read64(p));
+            v2 = round64(v2, read64(p + 8));
+            v3 = round64(v3, read64(p + 16));
+            v4 = round64(v4, read64(p + 24));
+            p += 32;
+        } while (p <= limit);
+
+        h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+        h = merge64(h, v1);
+        h = merge64(h, v2);
+        h = merge64(h, v3);
+        h = merge64(h, v4);
+    } else {
+        h = seed + PRIME5;
+    }
+
+    h += (uint64_t) size;
+
+    while (p + 8 <= end) {
+        h ^= round64(0, read64(p));
+        h = rotl(h, 27) * PRIME1 + PRIME4;
+        p += 8;
+    }
+    if (p + 4 <= end) {
+        h ^= (uint64_t) read32(p) * PRIME1;
+        h = rotl(h, 23) * PRIME2 + PRIME3;
+        p += 4;
+    }
+    while (p < end) {
+        h ^= (uint64_t) (*p) * PRIME5;
+        h = rotl(h, 11) * PRIME1;
+        ++p;
+    }
+
+    h ^= h >> 33;
+    h *= PRIME2;
+    h ^= h >> 29;
+    h *= PRIME3;
+    h ^= h >> 32;
+    return h;
+}
+
+/*!
+ * Hash the contents of a vector.
+ */
+template<typename T, typename A>
+static uint64_t hashArray(const std::vector<T, A> &v) {
+    return hashBytes(v.data(), v.size() * sizeof(T));
+}
+
+uint64_t StateHashes::combined() const {
+    return hashBytes(fields, sizeof(fields));
+}
+
+const char *stateFieldName(int field) {
+    static const char *names[STATE_FIELD_COUNT] = {"pos", "vel", "hits", "active", "score", "lives", "level",
+                                                   "pause/flags"};
+    return field >= 0 && field < STATE_FIELD_COUNT ? names[field] : "unknown";
+}
+
+void hashWorldFields(const World &world, StateHashes &out) {
+    const EntityStore &store = world.entities;
+
+    out.fields[STATE_POS] = hashArray(store.pos);
+    out.fields[STATE_VEL] = hashArray(store.vel);
+    out.fields[STATE_HITS] = hashArray(store.hits);
+    out.fields[STATE_ACTIVE] = hashArray(store.active);
+    out.fields[STATE_SCORE] = hashBytes(&world.score, sizeof(world.score));
+    out.fields[STATE_LIVES] = hashBytes(&world.playerLives, sizeof(world.playerLives));
+
+    const int level[] = {world.levelId, world.bricksLeft};
+    out.fields[STATE_LEVEL] = hashBytes(level, sizeof(level));
+
+    int flow[4] = {world.pauseReason, world.end, world.ballCaptured, 0};
+    memcpy(&flow[3], &world.pauseTimer, sizeof(float));
+    out.fields[STATE_FLOW] = hashBytes(flow, sizeof(flow));
+}
+
+uint64_t hashWorldState(const World &world) {
+    StateHashes hashes;
+    hashWorldFields(world, hashes);
+    return hashes.combined();
+}
+
+bool StateHashLog::record(const std::string &path) {
+    close();
+    file = fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        printf("Could not write hash log: %s\n", path.c_str());
+        return false;
+    }
+
+    StateHashLogHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "BJHL", 4);
+    header.version = HASH_LOG_VERSION;
+    header.fields = STATE_FIELD_COUNT;
+    fwrite(&header, sizeof(header), 1, file);
+
+    writing = true;
+    tick = 0;
+    diverged = -1;
+    return true;
+}
+
+bool StateHashLog::compare(const std::string &path) {
+    close();
+    file = fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        printf("Could not open hash log: %s\n", path.c_str());
+        return false;
+    }
+
+    StateHashLogHeader header;
+    if (fread(&header, sizeof(header), 1, file) != 1 || memcmp(header.magic, "BJHL", 4) != 0
+        || header.version != HASH_LOG_VERSION || header.fields != STATE_FIELD_COUNT) {
+        printf("Not a hash log or wrong version: %s\n", path.c_str());
+        close();
+        return false;
+    }
+
+    writing = false;
+    tick = 0;
+    diverged = -1;
+    return true;
+}
+
+bool StateHashLog::tickDone(const World &world) {
+    if (file == nullptr) {
+        return diverged < 0;
+    }
+
+    StateHashes hashes;
+    hashWorldFields(world, hashes);
+
+    if (writing) {
+        fwrite(hashes.fields, sizeof(hashes.fields), 1, file);
+        ++tick;
+        return true;
+    }
+
+    if (diverged >= 0) {
+        return false;
+    }
+
+    StateHashes reference;
+    if (fread(reference.fields, sizeof(reference.fields), 1, file) != 1) {
+        printf("Hash log ended at tick %lld\n", tick);
+        diverged = tick;
+        return false;
+    }
+
+    if (memcmp(hashes.fields, reference.fields, sizeof(hashes.fields)) != 0) {
+        diverged = tick;
+        printf("State diverged at tick %lld:", tick);
+        for (int f = 0; f < STATE_FIELD_COUNT; ++f) {
+            if (hashes.fields[f] != reference.fields[f]) {
+                printf(" %s", stateFieldName(f));
+            }
+        }
+        printf("\n");
+        return false;
+    }
+
+    ++tick;
+    return true;
+}
+
+void StateHashLog::close() {
+    if (file != nullptr) {
+        fclose(file);
+    }
+    file = nullptr;
+}
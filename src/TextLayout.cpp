@@ -0,0 +1,70 @@
+//
+// Created by jibbo on 4/7/21.
+//
+
+#include <TextLayout.h>
+
+void TextLayout::build() {
+    if (hasNumber) {
+        place(label + " " + std::to_string(number));
+    } else {
+        place(label);
+    }
+}
+
+void TextLayout::place(const std::string &text) {
+    quads.clear();
+    ++builds;
+
+    // rasterizing can grow the atlas, so the generation is taken after it
+    font->require(text);
+    generation = font->generation;
+
+    auto emit = [this](const GlyphQuad &q) {
+        quads.push_back(q);
+    };
+    layoutGlyphs(*font, text, pos, scale, alignment, emit);
+}
+
+bool TextLayout::set(FontAtlas &atlas, const std::string &text, const Vector3D &position, float size, int align) {
+    if (font == &atlas && generation == atlas.generation && !hasNumber && label == text && pos == position
+        && scale == size && alignment == align) {
+        return false;
+    }
+
+    font = &atlas;
+    label = text;
+    hasNumber = false;
+    pos = position;
+    scale = size;
+    alignment = align;
+    build();
+    return true;
+}
+
+bool TextLayout::set(FontAtlas &atlas, const std::string &text, int value, const Vector3D &position, float size,
+                     int align) {
+    if (font == &atlas && generation == atlas.generation && hasNumber && number == value && label == text
+        && pos == position && scale == size && alignment == align) {
+        return false;
+    }
+
+    font = &atlas;
+    label = text;
+    hasNumber = true;
+    number = value;
+    pos = position;
+    scale = size;
+    alignment = align;
+    build();
+    return true;
+}
+
+bool TextLayout::refresh() {
+    if (font == nullptr || generation == font->generation) {
+        return false;
+    }
+
+    build();
+    return true;
+}
@@ -0,0 +1,97 @@
+//
+// Created by jibbo on 3/28/21.
+//
+
+#include <ThreadPool.h>
+
+ThreadPool::ThreadPool(int threads) {
+    if (threads <= 0) {
+        threads = (int) std::thread::hardware_concurrency();
+    }
+    if (threads <= 0) {
+        threads = 1;
+    }
+
+    // the thread calling parallelFor works too, so one less worker keeps every core busy without oversubscribing
+    for (int i = 1; i < threads; ++i) {
+        workers.emplace_back(&ThreadPool::work, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+
+    for (std::thread &t : workers) {
+        t.join();
+    }
+}
+
+void ThreadPool::runChunks(std::unique_lock<std::mutex> &lock) {
+    while (next < count) {
+        int begin = next;
+        int end = begin + chunk < count ? begin + chunk : count;
+        next = end;
+
+        lock.unlock();
+        for (int i = begin; i < end; ++i) {
+            job(i);
+        }
+        lock.lock();
+
+        pending -= end - begin;
+        if (pending == 0) {
+            finished.notify_all();
+        }
+    }
+}
+
+void ThreadPool::work() {
+    std::unique_lock<std::mutex> lock(mutex);
+    unsigned long long seen = generation;
+
+    while (true) {
+        wake.wait(lock, [this, seen]() { return stopping || generation != seen; });
+        if (stopping) {
+            return;
+        }
+        seen = generation;
+
+        runChunks(lock);
+    }
+}
+
+void ThreadPool::parallelFor(int n, const std::function<void(int)> &fn, int grain) {
+    if (n <= 0) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+
+    int threads = size() + 1;
+    if (grain <= 0) {
+        // a few chunks per thread evens out items that take different amounts of time
+        grain = n / (threads * 8);
+        if (grain < 1) {
+            grain = 1;
+        }
+    }
+
+    job = fn;
+    count = n;
+    next = 0;
+    chunk = grain;
+    pending = n;
+    ++generation;
+    wake.notify_all();
+
+    runChunks(lock);
+    finished.wait(lock, [this]() { return pending == 0; });
+
+    job = nullptr;
+    count = 0;
+    next = 0;
+}
@@ -0,0 +1,262 @@
+//
+// Created by jibbo on 4/4/21.
+//
+
+#include <Trajectory.h>
+#include <Sweep.h>
+#include <cmath>
+#include <vector>
+
+/*!
+ * Contacts are moved this far off the surface, the same as World::sweep.
+ */
+static const float SKIN = 0.01f;
+
+TrajectoryPrediction predictBallPath(const World &world, const Vector3D &pos, const Vector3D &vel, float radius,
+                                     float targetY, int maxBounces) {
+    const WorldConfig &config = world.config;
+    const EntityStore &store = world.entities;
+    TrajectoryPrediction result;
+
+    // fraction of a base tick covered by one tick
+    float dt = (float) config.baseTickRate / (float) config.tickRate;
+
+    float minX = radius;
+    float maxX = (float) config.screenWidth - radius;
+    float maxY = (float) config.screenHeight - radius;
+    const Vector3D wallNormal[3] = {Vector3D(-1, 0, 0), Vector3D(1, 0, 0), Vector3D(0, -1, 0)};
+
+    // one row per march step, a step never skips a row of cells
+    float pitch = world.brickGrid.rowPitch > 0 ? world.brickGrid.rowPitch : (float) config.screenHeight;
+
+    Vector3D p = pos;
+    Vector3D v = vel;
+    if (Magnitude(v) > config.maxSpeed) {
+        v = Normalize(v) * config.maxSpeed;
+    }
+
+    // bricks hit on the way, once for every hit they took
+    std::vector<int> used;
+    auto hitsLeft = [&](int brick) {
+        int left = store.hits[brick];
+        for (int u : used) {
+            left -= u == brick;
+        }
+        return left;
+    };
+
+    for (int bounce = 0; bounce <= maxBounces; ++bounce) {
+        Vector3D step = v * dt;
+
+        // ticks until the target height or the first wall
+        float tEnd = INFINITY;
+        int wall = -1;
+        if (step.y < 0 && p.y > targetY) {
+            tEnd = (targetY - p.y) / step.y;
+        }
+        float wallT[3] = {INFINITY, INFINITY, INFINITY};
+        if (step.x > 0) wallT[0] = (maxX - p.x) / step.x;
+        if (step.x < 0) wallT[1] = (minX - p.x) / step.x;
+        if (step.y > 0) wallT[2] = (maxY - p.y) / step.y;
+        for (int w = 0; w < 3; ++w) {
+            if (wallT[w] < tEnd) {
+                tEnd = fmaxf(wallT[w], 0.0f);
+                wall = w;
+            }
+        }
+        if (std::isinf(tEnd)) {
+            // not moving, or already below the target and moving down
+            return result;
+        }
+
+        // march the segment through the brick grid
+        Vector3D segment = step * tEnd;
+        int pieces = (int) ceilf(Magnitude(segment) / pitch);
+        pieces = pieces < 1 ? 1 : pieces;
+        Vector3D piece = segment / (float) pieces;
+
+        SweepHit best;
+        int bestBrick = -1;
+        float tHit = 0;
+        Vector3D hitStart = p;
+        for (int k = 0; k < pieces && bestBrick < 0; ++k) {
+            Vector3D start = p + piece * (float) k;
+            Vector3D end = start + piece;
+            world.brickGrid.query(fminf(start.x, end.x) - radius, fminf(start.y, end.y) - radius,
+                                  fmaxf(start.x, end.x) + radius, fmaxf(start.y, end.y) + radius,
+                                  [&](int brick) {
+                SweepHit h;
+                if (store.active[brick] && hitsLeft(brick) > 0
+                    && SweepCircleRect(start, piece, radius, store.pos[brick],
+                                       store.width[brick] / 2.0f, store.height[brick] / 2.0f, h)
+                    && h.t < best.t) {
+                    best = h;
+                    bestBrick = brick;
+                }
+            });
+            if (bestBrick >= 0) {
+                tHit = ((float) k + best.t) / (float) pieces * tEnd;
+                hitStart = start + piece * best.t;
+            }
+        }
+
+        if (bestBrick >= 0) {
+            result.ticks += tHit;
+            result.bounces += 1;
+            result.brickHits += 1;
+            used.push_back(bestBrick);
+
+            // same response as World::bounce for a resting rectangle
+            if (best.t == 0) {
+                p = best.point + best.normal * (radius * 1.1f);
+            } else {
+                p = hitStart + best.normal * SKIN;
+            }
+            if (Dot(best.normal, v) < 0) {
+                v -= Project(v, best.normal) * 2;
+            }
+            continue;
+        }
+
+        p = p + segment;
+        result.ticks += tEnd;
+
+        if (wall < 0) {
+            result.reached = true;
+            result.point = Vector3D(p.x, targetY, 0);
+            result.velocity = v;
+            return result;
+        }
+
+        result.bounces += 1;
+        p = p + wallNormal[wall] * SKIN;
+        v -= Project(v, wallNormal[wall]) * 2;
+    }
+
+    return result;
+}
+
+TrajectoryPrediction predictBall(const World &world, int maxBounces) {
+    const EntityStore &store = world.entities;
+    int ball = world.ball.id;
+    int player = world.player.id;
+
+    float radius = store.radius[ball];
+    float targetY = store.pos[player].y + store.height[player] / 2.0f + radius;
+    return predictBallPath(world, store.pos[ball], store.vel[ball], radius, targetY, maxBounces);
+}
+
+Autopilot::Autopilot(uint32_t seed) : rng(seed ? seed : 1) {
+}
+
+void Autopilot::chooseAim(const World &world) {
+    const WorldConfig &config = world.config;
+    const EntityStore &store = world.entities;
+    int ball = world.ball.id;
+    int player = world.player.id;
+
+    float width = store.width[player];
+    float radius = store.radius[ball];
+    const Vector3D &contact = path.point;
+    const Vector3D &in = path.velocity;
+
+    int bestHits = -1;
+    float bestAim = in.x < 0 ? width * 0.45f : -width * 0.45f;
+    for (int n = 0; n < AIM_SPOTS; ++n) {
+        int spot = (firstSpot + n) % AIM_SPOTS;
+        float offset = (-0.45f + 0.9f * (float) spot / (float) (AIM_SPOTS - 1)) * width;
+        float paddleX = contact.x - offset;
+        if (paddleX < width / 2.0f || paddleX > (float) config.screenWidth - width / 2.0f) {
+            continue;
+        }
+
+        // the paddle normal of World::bounce, pointing away from a spot far below the paddle center
+        Vector3D below = Vector3D(paddleX, store.pos[player].y - store.height[player] * 10, 0);
+        Vector3D normal = Normalize(contact - below);
+        Vector3D out = in;
+        if (Dot(normal, out) < 0) {
+            out -= Project(out, normal) * 2;
+        }
+        if (Magnitude(out) > config.maxSpeed) {
+            out = Normalize(out) * config.maxSpeed;
+        }
+
+        // flat returns roll along the paddle and off its end
+        if (out.y < 0.5f * Magnitude(out)) {
+            continue;
+        }
+
+        TrajectoryPrediction back = predictBallPath(world, contact + normal * SKIN, out, radius, contact.y);
+        if (back.brickHits > bestHits) {
+            bestHits = back.brickHits;
+            bestAim = offset;
+        }
+    }
+    aim = bestAim;
+}
+
+WorldInput Autopilot::next(const World &world) {
+    const WorldConfig &config = world.config;
+    const EntityStore &store = world.entities;
+    int ball = world.ball.id;
+    int player = world.player.id;
+    WorldInput in;
+
+    if (world.ballCaptured) {
+        in.shoot = true;
+        havePath = false;
+        path = TrajectoryPrediction();
+        return in;
+    }
+
+    const Vector3D &ballPos = store.pos[ball];
+    const Vector3D &ballVel = store.vel[ball];
+    float paddleX = store.pos[player].x;
+    float paddleVX = store.vel[player].x;
+    float width = store.width[player];
+
+    if (!havePath || !(ballVel == pathVelocity)) {
+        // the ball turned up close to the paddle, it was just returned, ties go to another spot next time
+        float paddleTop = store.pos[player].y + store.height[player] / 2.0f;
+        if (havePath && pathVelocity.y < 0 && ballVel.y > 0
+            && ballPos.y < paddleTop + store.radius[ball] + config.maxSpeed * 2) {
+            // xorshift32, the same on every platform
+            rng ^= rng << 13;
+            rng ^= rng >> 17;
+            rng ^= rng << 5;
+            firstSpot = (int) (rng % AIM_SPOTS);
+        }
+
+        path = predictBall(world);
+        pathVelocity = ballVel;
+        havePath = true;
+        if (path.reached) {
+            chooseAim(world);
+        }
+    }
+
+    float target = (path.reached ? path.point.x : ballPos.x) - aim;
+    target = fminf(fmaxf(target, width / 2.0f), (float) config.screenWidth - width / 2.0f);
+
+    // fraction of a base tick covered by one tick
+    float dt = (float) config.baseTickRate / (float) config.tickRate;
+
+    // distance drag alone lets the paddle travel, the geometric sum of the remaining ticks
+    float keep = powf(store.drag[player], dt);
+    float coast = paddleVX * dt * keep / (1.0f - keep);
+
+    const float DEADBAND = 2.0f;
+    float error = target - paddleX;
+    if (error > DEADBAND) {
+        in.right = coast < error;
+        in.left = coast > error + DEADBAND * 4;
+    } else if (error < -DEADBAND) {
+        in.left = coast > error;
+        in.right = coast < error - DEADBAND * 4;
+    } else {
+        // on target, brake
+        in.left = coast > DEADBAND;
+        in.right = coast < -DEADBAND;
+    }
+    return in;
+}
@@ -0,0 +1,96 @@
+//
+// Created by jibbo on 3/24/21.
+//
+
+#include <VoicePool.h>
+#include <Clip.h>
+
+Voice &VoicePool::claim() {
+    Voice *oldest = nullptr;
+    Voice *oldestLooping = nullptr;
+
+    for (Voice &v : voices) {
+        if (!v.active) {
+            return v;
+        }
+
+        if (v.clip->loop) {
+            if (oldestLooping == nullptr || v.started < oldestLooping->started) {
+                oldestLooping = &v;
+            }
+        } else if (oldest == nullptr || v.started < oldest->started) {
+            oldest = &v;
+        }
+    }
+
+    // keep the music going as long as there are sound effects to steal
+    return oldest != nullptr ? *oldest : *oldestLooping;
+}
+
+void VoicePool::play(Clip *clip) {
+    if (clip == nullptr || clip->clipLen == 0) {
+        return;
+    }
+
+    Voice &v = claim();
+    v.clip = clip;
+    v.trackPos = 0;
+    v.started = triggers++;
+    v.active = true;
+}
+
+void VoicePool::stop(Clip *clip) {
+    for (Voice &v : voices) {
+        if (v.active && v.clip == clip) {
+            v.active = false;
+        }
+    }
+}
+
+void VoicePool::stopAll() {
+    for (Voice &v : voices) {
+        v.active = false;
+    }
+}
+
+int VoicePool::activeCount() const {
+    int count = 0;
+    for (const Voice &v : voices) {
+        count += v.active;
+    }
+    return count;
+}
+
+void VoicePool::mix(Uint8 *stream, Uint32 len) {
+    // lengths and positions are in bytes, the mixer works in 16 bit samples
+    mixer.begin(len / 2);
+
+    for (Voice &v : voices) {
+        if (!v.active) {
+            continue;
+        }
+
+        const Clip *clip = v.clip;
+        Uint32 written = 0;
+        while (written < len) {
+            Uint32 n = clip->clipLen - v.trackPos;
+            if (n > len - written) {
+                n = len - written;
+            }
+
+            mixer.add(written / 2, (const int16_t *) &clip->data[v.trackPos], n / 2);
+            written += n;
+            v.trackPos += n;
+
+            if (v.trackPos >= clip->clipLen) {
+                if (!clip->loop) {
+                    v.active = false;
+                    break;
+                }
+                v.trackPos = 0;
+            }
+        }
+    }
+
+    mixer.resolve((int16_t *) stream);
+}
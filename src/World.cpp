@@ -0,0 +1,504 @@
+//
+// Created by jibbo on 3/14/21.
+//
+
+#include <World.h>
+#include <LevelFile.h>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <streambuf>
+
+/*!
+ * Extra balls split off the ball fan out up to this angle to each side of its direction, 45 degrees.
+ */
+static const float SPLIT_SPREAD = 0.7853982f;
+
+void World::startUp() {
+    Entity paddle;
+    paddle.pos = Vector3D(((float) config.screenWidth) / 2.0f, ((float) config.screenHeight) * 1.0f / 5.0f, 0);
+    paddle.vel = Vector3D(0, 0, 0);
+    paddle.width = 100;
+    paddle.height = 10;
+
+    Entity circle;
+    circle.pos = Vector3D(((float) config.screenWidth) / 2.0f, ((float) config.screenHeight) / 2.0f, 0);
+    circle.shapeId = 1;
+    circle.radius = 10;
+    circle.drag = 1.0f;
+    circle.reflects = true;
+    circle.vel = Vector3D(2.0f, 2.0f, 0.0f);
+
+    player = EntityHandle(&entities, entities.add(paddle));
+    ball = EntityHandle(&entities, entities.add(circle));
+
+    playerLives = config.lives;
+}
+
+void World::clearLevel() {
+    // extra balls are appended after the bricks, removing them first keeps the brick indices of the next level
+    entities.removeType(1);
+    entities.removeType(2);
+    bricksLeft = 0;
+    extraBalls = 0;
+
+    brickGrid.reset(0, 0);
+}
+
+int World::splitBall(int count) {
+    if (ballCaptured || count <= 0) {
+        return 0;
+    }
+
+    Vector3D dir = ball.vel();
+    if (Magnitude(dir) == 0) {
+        dir = shootVector;
+    }
+
+    Entity extra;
+    extra.pos = ball.pos();
+    extra.shapeId = 1;
+    extra.typeId = 1;
+    extra.radius = ball.radius();
+    extra.drag = entities.drag[ball.id];
+    extra.reflects = true;
+
+    // one allocation for the whole split, then the velocities alternate sides of the fan
+    int first = entities.addMany(count, extra);
+    int perSide = (count + 1) / 2;
+    for (int k = 0; k < count; ++k) {
+        float angle = SPLIT_SPREAD * (float) (k / 2 + 1) / (float) perSide * ((k & 1) ? -1.0f : 1.0f);
+        float c = cosf(angle);
+        float s = sinf(angle);
+        entities.vel[first + k] = Vector3D(dir.x * c - dir.y * s, dir.x * s + dir.y * c, 0);
+    }
+
+    extraBalls += count;
+    return count;
+}
+
+void World::loadLevel(const std::string &path) {
+    if (isCompiledLevel(path)) {
+        LevelFile file;
+        if (file.open(path)) {
+            loadLevelLayout(file.layout());
+        }
+        return;
+    }
+
+    std::ifstream t(path);
+    std::string str((std::istreambuf_iterator<char>(t)),std::istreambuf_iterator<char>());
+
+    loadLevelData(str);
+}
+
+void World::loadLevelData(const std::string &str) {
+    LevelText text;
+    text.parse(str);
+    loadLevelLayout(text.layout());
+}
+
+void World::loadLevelLayout(const LevelLayout &layout) {
+    brickGrid.reset((float) (config.screenHeight - config.brickTopOffset),
+                    (float) (config.brickHeight + config.brickSpacing));
+
+    Entity brick;
+    brick.vel = Vector3D(0, 0, 0);
+    brick.typeId = 2;
+
+    // one pass writes the per brick fields, the shared ones are filled by addUnplaced. Bricks never move,
+    // so their future and previous positions aren't written at all
+    int id = entities.addUnplaced((int) layout.bricks, brick);
+    Vector3D *pos = entities.pos.data();
+    float *width = entities.width.data();
+    float *height = entities.height.data();
+    int *hits = entities.hits.data();
+    const float *rect = layout.rectsMatch(config) ? layout.rects : nullptr;
+    const float brickHeight = (float) config.brickHeight;
+
+    size_t cell = 0;
+    for (uint32_t r = 0; r < layout.rows; ++r) {
+        int cols = (int) layout.rowCols[r];
+        float brickWidth = config.brickWidth(cols);
+        float y = config.brickY((int) r);
+
+        int row = brickGrid.addRow(brickWidth + (float) config.brickSpacing, cols);
+
+        for (int i = 0; i < cols; ++i, ++cell) {
+            int n = layout.hits[cell];
+            if (n == 0) {
+                continue;
+            }
+
+            if (rect != nullptr) {
+                pos[id] = Vector3D(rect[0], rect[1], 0);
+                width[id] = rect[2];
+                height[id] = rect[3];
+                rect += 4;
+            } else {
+                pos[id] = Vector3D(config.brickX(i, brickWidth), y, 0);
+                width[id] = brickWidth;
+                height[id] = brickHeight;
+            }
+            hits[id] = n;
+
+            brickGrid.set(row, i, id);
+            ++id;
+        }
+    }
+
+    bricksLeft += (int) layout.bricks;
+}
+
+void World::levelUpdate(bool win) {
+    ballCaptured = true;
+    ball.vel() = Vector3D(0, 0, 0);
+    clearLevel();
+    events.levelChanged = true;
+
+    if (win && levelId >= (int) levels.size() - 1) {
+        pauseReason = PAUSE_WIN;
+        end = true;
+    } else if (win) {
+        pauseReason = PAUSE_NEXT_LEVEL;
+        ++levelId;
+        playerLives = config.lives;
+        loadLevelLayout(levels.at(levelId));
+    } else {
+        pauseReason = PAUSE_LOSE;
+        score = 0;
+        playerLives = config.lives;
+        if (levelId < (int) levels.size()) {
+            loadLevelLayout(levels.at(levelId));
+        }
+    }
+
+    pauseTimer = config.pauseDelay;
+}
+
+void World::input(const WorldInput &in) {
+    // fraction of a base tick covered by one tick
+    float dt = (float) config.baseTickRate / (float) config.tickRate;
+
+    if (in.left) {
+        player.vel().x -= config.paddleSpeed * dt;
+    }
+
+    if (in.right) {
+        player.vel().x += config.paddleSpeed * dt;
+    }
+
+    if (in.shoot && ballCaptured) {
+        ball.vel() = shootVector + player.vel();
+        ballCaptured = false;
+        splitBall(config.multiBall);
+    }
+}
+
+void World::bounce(int rect, int ball, const SweepHit &hit) {
+    EntityStore &store = entities;
+
+    Vector3D &ballPos = store.f_pos[ball];
+    Vector3D &ballVel = store.vel[ball];
+    float radius = store.radius[ball];
+
+    events.hits += 1;
+    Vector3D normal = hit.normal;
+
+    // overlapping shapes are pushed apart, swept contacts are already touching
+    if (hit.t == 0) {
+        ballPos = hit.point + normal * (radius * 1.1f);
+    }
+
+    if (store.typeId[rect] == 0) {
+        const Vector3D &rectPos = store.f_pos[rect];
+        normal = Normalize(ballPos - (rectPos + Vector3D(0, -store.height[rect] * 10, 0)));
+    }
+
+    const Vector3D &rectVel = store.vel[rect];
+    if (Dot(normal, ballVel) < 0) {
+        ballVel -= Project(ballVel, normal) * 2;
+    } else {
+        ballVel += (normal * Magnitude(rectVel));
+    }
+    ballVel += rectVel * 0.5;
+
+    if (store.typeId[rect] == 2) {
+        events.bricksHit.push_back(rect);
+        score += store.hits[rect];
+        store.hits[rect] -= 1;
+        if (store.hits[rect] == 0) {
+            store.active[rect] = false;
+            bricksLeft -= 1;
+        }
+    }
+}
+
+void World::sweep(int ball, float dt) {
+    EntityStore &store = entities;
+
+    // contacts are moved this far off the surface so the next sweep doesn't start touching it
+    const float SKIN = 0.01f;
+
+    float radius = store.radius[ball];
+    float minX = radius;
+    float maxX = (float) config.screenWidth - radius;
+    float minY = radius;
+    float maxY = (float) config.screenHeight - radius;
+
+    Vector3D &vel = store.vel[ball];
+    Vector3D &pos = store.f_pos[ball];
+    pos = store.pos[ball];
+
+    // fraction of the tick not yet travelled
+    float remaining = 1;
+
+    for (int n = 0; n < config.maxBounces && remaining > 0; ++n) {
+        Vector3D delta = vel * (dt * remaining);
+
+        SweepHit best;
+        int bestRect = -1;
+        bool bestWall = false;
+
+        // moving rectangles (the paddle) are swept with the relative movement
+        for (int r : dynamicRects) {
+            if (!store.active[r]) {
+                continue;
+            }
+
+            Vector3D rectDelta = store.f_pos[r] - store.pos[r];
+            Vector3D rectStart = store.pos[r] + rectDelta * (1 - remaining);
+
+            SweepHit h;
+            if (SweepCircleRect(pos, delta - rectDelta * remaining, radius, rectStart,
+                                store.width[r] / 2.0f, store.height[r] / 2.0f, h) && h.t < best.t) {
+                best = h;
+                bestRect = r;
+            }
+        }
+
+        // bricks in the grid cells covered by the whole path
+        Vector3D end = pos + delta;
+        brickGrid.query(fminf(pos.x, end.x) - radius, fminf(pos.y, end.y) - radius,
+                        fmaxf(pos.x, end.x) + radius, fmaxf(pos.y, end.y) + radius,
+                        [&](int brick) {
+            SweepHit h;
+            if (store.active[brick]
+                && SweepCircleRect(pos, delta, radius, store.pos[brick],
+                                   store.width[brick] / 2.0f, store.height[brick] / 2.0f, h)
+                && h.t < best.t) {
+                best = h;
+                bestRect = brick;
+            }
+        });
+
+        // walls, only when moving towards them
+        float wallT[4] = {2, 2, 2, 2};
+        if (delta.x > 0) wallT[0] = (maxX - pos.x) / delta.x;
+        if (delta.x < 0) wallT[1] = (minX - pos.x) / delta.x;
+        if (delta.y > 0) wallT[2] = (maxY - pos.y) / delta.y;
+        if (delta.y < 0) wallT[3] = (minY - pos.y) / delta.y;
+        const Vector3D wallNormal[4] = {Vector3D(-1, 0, 0), Vector3D(1, 0, 0), Vector3D(0, -1, 0), Vector3D(0, 1, 0)};
+        for (int w = 0; w < 4; ++w) {
+            float t = fmaxf(wallT[w], 0.0f);
+            if (t <= 1 && t < best.t) {
+                best.t = t;
+                best.normal = wallNormal[w];
+                bestRect = -1;
+                bestWall = true;
+            }
+        }
+
+        if (!bestWall && bestRect == -1) {
+            pos = end;
+            break;
+        }
+
+        pos = pos + delta * best.t + best.normal * SKIN;
+        remaining *= 1 - best.t;
+
+        if (bestWall) {
+            if (store.reflects[ball]) {
+                vel -= Project(vel, best.normal) * 2;
+            } else {
+                vel -= Project(vel, best.normal);
+            }
+        } else {
+            bounce(bestRect, ball, best);
+        }
+    }
+
+    pos.x = fminf(fmaxf(pos.x, minX), maxX);
+    pos.y = fminf(fmaxf(pos.y, minY), maxY);
+}
+
+void World::gatherDynamic() {
+    const EntityStore &store = entities;
+    if (dynamicRevision == store.revision) {
+        return;
+    }
+
+    dynamicEntities.clear();
+    dynamicRects.clear();
+    for (int i = 0; i < store.size(); ++i) {
+        if (store.typeId[i] != 2) {
+            dynamicEntities.emplace_back(i);
+            if (store.shapeId[i] == 0) {
+                dynamicRects.emplace_back(i);
+            }
+        }
+    }
+    dynamicRevision = store.revision;
+}
+
+void World::dropLostBalls() {
+    EntityStore &store = entities;
+    float lostBelow = player.pos().y - player.height()/2;
+
+    int lost = 0;
+    int spare = -1;
+    for (int i : dynamicEntities) {
+        if (store.typeId[i] != 1 || !store.active[i]) {
+            continue;
+        }
+        if (store.pos[i].y < lostBelow) {
+            store.active[i] = false;
+            ++lost;
+        } else if (spare < 0) {
+            spare = i;
+        }
+    }
+
+    if (ball.pos().y < lostBelow) {
+        if (spare >= 0) {
+            // an extra ball carries on as the ball, the handle and the rules keep pointing at one entity
+            ball.pos() = store.pos[spare];
+            ball.f_pos() = store.f_pos[spare];
+            ball.vel() = store.vel[spare];
+            store.p_pos[ball.id] = store.p_pos[spare];
+            store.active[spare] = false;
+            ++lost;
+        } else {
+            playerLives -= 1;
+            ballCaptured = true;
+        }
+    }
+
+    if (lost > 0) {
+        store.removeInactive(1);
+        extraBalls -= lost;
+        gatherDynamic();
+    }
+}
+
+void World::step(const WorldInput &in) {
+    EntityStore &store = entities;
+    events.clear();
+
+    // fraction of a base tick covered by one tick
+    float dt = (float) config.baseTickRate / (float) config.tickRate;
+
+    // bricks never move, only the moving entities are integrated
+    gatherDynamic();
+
+    for (int i : dynamicEntities) {
+        store.p_pos[i] = store.pos[i];
+    }
+
+    input(in);
+
+    if (pauseTimer > 0 && !end) {
+        pauseTimer -= 1.0f / (float) config.tickRate;
+        return;
+    }
+
+    // a serve may have split off new balls
+    gatherDynamic();
+    dropLostBalls();
+
+    if (ballCaptured) {
+        ball.pos() = player.pos() + Vector3D(0, 10, 0);
+        ball.vel() = Vector3D(0, 0, 0);
+    }
+
+    for (int i : dynamicEntities) {
+        Vector3D &vel = store.vel[i];
+        Vector3D &f_pos = store.f_pos[i];
+
+        // drag is given per base tick
+        vel *= (dt == 1.0f) ? store.drag[i] : powf(store.drag[i], dt);
+
+        if (Magnitude(vel) > config.maxSpeed) {
+            vel = Normalize(vel) * config.maxSpeed;
+        }
+
+        // free balls are swept once every rectangle has moved
+        if (store.shapeId[i] == 1 && (i != ball.id || !ballCaptured)) {
+            continue;
+        }
+
+        f_pos = store.pos[i] + vel * dt;
+
+        // extents from the center to the left/right and bottom/top of the shape
+        float extentX = store.radius[i];
+        float extentBottom = store.radius[i];
+        float extentTop = store.radius[i];
+        if (store.shapeId[i] == 0) {
+            extentX = store.width[i] / 2.0f;
+            extentBottom = store.height[i] / 2.0f;
+            extentTop = store.height[i];
+        }
+
+        bool hitWall = false;
+        Vector3D normal = Vector3D(0, 0, 0);
+        if (f_pos.x + extentX > (float) config.screenWidth) {
+            f_pos.x = (float) config.screenWidth - extentX;
+            normal = Vector3D(-1, 0, 0);
+            hitWall = true;
+        }
+
+        if (f_pos.x - extentX < 0) {
+            f_pos.x = extentX;
+            normal = Vector3D(1, 0, 0);
+            hitWall = true;
+        }
+
+        if (f_pos.y + extentTop > (float) config.screenHeight) {
+            f_pos.y = (float) config.screenHeight - extentTop;
+            normal = Vector3D(0, -1, 0);
+            hitWall = true;
+        }
+
+        if (f_pos.y - extentBottom < 0) {
+            f_pos.y = extentBottom;
+            normal = Vector3D(0, 1, 0);
+            hitWall = true;
+        }
+
+        if (hitWall) {
+            if (store.reflects[i]) {
+                vel -= Project(vel, normal) * 2;
+            } else {
+                vel -= Project(vel, normal);
+            }
+        }
+    }
+
+    for (int i : dynamicEntities) {
+        if (store.shapeId[i] == 1 && store.active[i] && (i != ball.id || !ballCaptured)) {
+            sweep(i, dt);
+        }
+    }
+
+    for (int i : dynamicEntities) {
+        store.pos[i] = store.f_pos[i];
+    }
+
+    if (bricksLeft == 0) {
+        levelUpdate(true);
+    }
+
+    if (playerLives == 0) {
+        levelUpdate(false);
+    }
+}
@@ -0,0 +1,587 @@
+//
+// Created by jibbo on 3/30/21.
+//
+
+#include <WorldBatch.h>
+#include <cmath>
+#include <cstring>
+
+/*!
+ * Number of lane arrays carved out of the storage.
+ */
+static const int LANE_ARRAYS = 11;
+
+/*!
+ * Contacts moved this far off the surface so the next sweep doesn't start touching it, the SKIN of World::sweep.
+ */
+static const float SKIN = 0.01f;
+
+/*!
+ * \brief Contact of a moving circle in every lane, see SweepHit.
+ */
+struct LaneHit {
+    Lanes t;        /**<  fraction of the movement before the contact, 0 if the shapes already overlap */
+    Lanes normalX;  /**<  contact normal pointing from the obstacle towards the circle */
+    Lanes normalY;  /**<  contact normal pointing from the obstacle towards the circle */
+    Lanes pointX;   /**<  closest point on the obstacle at the contact */
+    Lanes pointY;   /**<  closest point on the obstacle at the contact */
+};
+
+/*!
+ * Copy the contacts of the picked lanes.
+ */
+static void takeHit(LaneMask take, const LaneHit &from, LaneHit &to) {
+    to.t = Select(take, from.t, to.t);
+    to.normalX = Select(take, from.normalX, to.normalX);
+    to.normalY = Select(take, from.normalY, to.normalY);
+    to.pointX = Select(take, from.pointX, to.pointX);
+    to.pointY = Select(take, from.pointY, to.pointY);
+}
+
+/*!
+ * SweepCircleRect on lanes, every branch is evaluated and the lanes pick theirs.
+ * @param candidates lanes to test, the others never hit
+ * @param hit receives the contacts, only meaningful in the lanes that hit
+ * @return lanes in which the circle touches the rectangle during the movement
+ */
+static LaneMask sweepCircleRect(Lanes startX, Lanes startY, Lanes deltaX, Lanes deltaY, Lanes radius,
+                                Lanes centerX, Lanes centerY, Lanes halfWidth, Lanes halfHeight,
+                                LaneMask candidates, LaneHit &hit) {
+    const Lanes zero = SplatLanes(0);
+    const Lanes one = SplatLanes(1);
+    const Lanes minusOne = SplatLanes(-1);
+
+    Lanes minX = centerX - halfWidth;
+    Lanes maxX = centerX + halfWidth;
+    Lanes minY = centerY - halfHeight;
+    Lanes maxY = centerY + halfHeight;
+    Lanes r2 = radius * radius;
+
+    // already overlapping, a circle exactly touching only hits when it moves into the rectangle
+    Lanes closestX = Min(Max(startX, minX), maxX);
+    Lanes closestY = Min(Max(startY, minY), maxY);
+    Lanes dx = startX - closestX;
+    Lanes dy = startY - closestY;
+    Lanes d2 = Dot(dx, dy, dx, dy);
+    LaneMask touchingInward = ~(d2 < r2) & ~(d2 > r2) & (Dot(dx, dy, deltaX, deltaY) < zero);
+    LaneMask overlap = ((d2 < r2) | touchingInward) & candidates;
+
+    // center inside the rectangle, leave through the closest face
+    Lanes left = startX - minX;
+    Lanes right = maxX - startX;
+    Lanes bottom = startY - minY;
+    Lanes top = maxY - startY;
+    Lanes m = Min(Min(left, right), Min(bottom, top));
+    LaneMask isLeft = ~(left > m);
+    LaneMask isRight = ~isLeft & ~(right > m);
+    LaneMask isX = isLeft | isRight;
+    LaneMask isBottom = ~isX & ~(bottom > m);
+
+    LaneMask outside = (dx != zero) | (dy != zero);
+    Lanes nx = dx;
+    Lanes ny = dy;
+    Normalize(nx, ny);
+    LaneHit overlapHit;
+    overlapHit.t = zero;
+    overlapHit.normalX = Select(outside, nx, Select(isLeft, minusOne, Select(isRight, one, zero)));
+    overlapHit.normalY = Select(outside, ny, Select(isX, zero, Select(isBottom, minusOne, one)));
+    overlapHit.pointX = Select(outside, closestX, Select(isLeft, minX, Select(isRight, maxX, startX)));
+    overlapHit.pointY = Select(outside, closestY, Select(isX, startY, Select(isBottom, minY, maxY)));
+
+    // slab test against the rectangle grown by the radius
+    Lanes tEnter = zero;
+    Lanes tExit = one;
+    Lanes normalX = zero;
+    Lanes normalY = zero;
+    LaneMask miss = ~candidates | overlap;
+
+    const Lanes lo[2] = {minX - radius, minY - radius};
+    const Lanes hi[2] = {maxX + radius, maxY + radius};
+    const Lanes p[2] = {startX, startY};
+    const Lanes d[2] = {deltaX, deltaY};
+    for (int axis = 0; axis < 2; ++axis) {
+        LaneMask still = ~(d[axis] != zero);
+        miss = miss | (still & ((p[axis] < lo[axis]) | (p[axis] > hi[axis])));
+
+        Lanes inv = one / Select(still, one, d[axis]);
+        Lanes t0 = (lo[axis] - p[axis]) * inv;
+        Lanes t1 = (hi[axis] - p[axis]) * inv;
+        LaneMask swap = t0 > t1;
+        Lanes tNear = Select(swap, t1, t0);
+        Lanes tFar = Select(swap, t0, t1);
+        Lanes side = Select(swap, one, minusOne);
+
+        LaneMask enter = (tNear > tEnter) & ~still;
+        tEnter = Select(enter, tNear, tEnter);
+        normalX = Select(enter, axis == 0 ? side : zero, normalX);
+        normalY = Select(enter, axis == 0 ? zero : side, normalY);
+        tExit = Select((tFar < tExit) & ~still, tFar, tExit);
+        miss = miss | (tEnter > tExit);
+    }
+
+    Lanes contactX = startX + deltaX * tEnter;
+    Lanes contactY = startY + deltaY * tEnter;
+    LaneMask inSpan = (~(contactX < minX) & ~(contactX > maxX)) | (~(contactY < minY) & ~(contactY > maxY));
+
+    // a face hit needs an entered slab, a circle only resting on a face doesn't move into it
+    LaneMask entered = (normalX != zero) | (normalY != zero);
+    LaneMask faceHit = inSpan & entered & ~miss;
+
+    // the grown rectangle has rounded corners, trace the center against the corner circle
+    Lanes cornerX = Select(contactX < minX, minX, maxX);
+    Lanes cornerY = Select(contactY < minY, minY, maxY);
+    Lanes mx = startX - cornerX;
+    Lanes my = startY - cornerY;
+    Lanes a = Dot(deltaX, deltaY, deltaX, deltaY);
+    Lanes b = Dot(mx, my, deltaX, deltaY);
+    Lanes c = Dot(mx, my, mx, my) - r2;
+    Lanes disc = b * b - a * c;
+    LaneMask solvable = (a != zero) & ~(disc < zero);
+    Lanes t = (zero - b - Sqrt(Max(disc, zero))) / Select(solvable, a, one);
+
+    // touching the corner at the start only counts when moving towards it
+    LaneMask startTouch = ~(t != zero) & ~(b < zero);
+    LaneMask cornerHit = ~inSpan & ~miss & solvable & ~(t < zero) & ~(t > one) & ~startTouch;
+    Lanes cnx = startX + deltaX * t - cornerX;
+    Lanes cny = startY + deltaY * t - cornerY;
+    Normalize(cnx, cny);
+
+    hit = overlapHit;
+    hit.t = Select(faceHit, tEnter, Select(cornerHit, t, hit.t));
+    hit.normalX = Select(faceHit, normalX, Select(cornerHit, cnx, hit.normalX));
+    hit.normalY = Select(faceHit, normalY, Select(cornerHit, cny, hit.normalY));
+    hit.pointX = Select(faceHit, Min(Max(contactX, minX), maxX), Select(cornerHit, cornerX, hit.pointX));
+    hit.pointY = Select(faceHit, Min(Max(contactY, minY), maxY), Select(cornerHit, cornerY, hit.pointY));
+    return overlap | faceHit | cornerHit;
+}
+
+void WorldBatch::startUp(int games, const LevelLayout &level) {
+    count = games > 0 ? games : 0;
+    padded = (count + Lanes::WIDTH - 1) / Lanes::WIDTH * Lanes::WIDTH;
+    int groups = padded / Lanes::WIDTH;
+
+    storage.assign((size_t) LANE_ARRAYS * padded + LANES_ALIGNMENT / sizeof(float), 0.0f);
+    uintptr_t address = (uintptr_t) storage.data();
+    float *base = (float *) ((address + LANES_ALIGNMENT - 1) & ~(uintptr_t) (LANES_ALIGNMENT - 1));
+
+    // every array is a whole number of vectors long, so each one starts vector aligned
+    float **arrays[LANE_ARRAYS] = {&ballX, &ballY, &ballVX, &ballVY, &paddleX, &paddleVX,
+                                   &captured, &left, &right, &shoot, &running};
+    for (int i = 0; i < LANE_ARRAYS; ++i) {
+        *arrays[i] = base + (size_t) i * padded;
+    }
+
+    paddleY = (float) config.screenHeight * 1.0f / 5.0f;
+
+    brickX.clear();
+    brickY.clear();
+    brickHalfW.clear();
+    brickHalfH.clear();
+    brickHits.clear();
+    rowFirst.clear();
+    rowBottom.clear();
+    rowTop.clear();
+    fieldBottom = (float) config.screenHeight;
+
+    const float *rect = level.rectsMatch(config) ? level.rects : nullptr;
+    size_t cell = 0;
+    for (uint32_t r = 0; r < level.rows; ++r) {
+        int cols = (int) level.rowCols[r];
+        float width = config.brickWidth(cols);
+        float y = config.brickY((int) r);
+        int first = (int) brickX.size();
+        float bottom = (float) config.screenHeight;
+        float top = 0;
+
+        for (int i = 0; i < cols; ++i, ++cell) {
+            int n = level.hits[cell];
+            if (n == 0) {
+                continue;
+            }
+
+            float x = config.brickX(i, width);
+            float w = width;
+            float h = (float) config.brickHeight;
+            float cy = y;
+            if (rect != nullptr) {
+                x = rect[0];
+                cy = rect[1];
+                w = rect[2];
+                h = rect[3];
+                rect += 4;
+            }
+
+            brickX.push_back(x);
+            brickY.push_back(cy);
+            brickHalfW.push_back(w / 2.0f);
+            brickHalfH.push_back(h / 2.0f);
+            brickHits.push_back((uint8_t) n);
+            bottom = fminf(bottom, cy - h / 2.0f);
+            top = fmaxf(top, cy + h / 2.0f);
+        }
+
+        if ((int) brickX.size() > first) {
+            rowFirst.push_back(first);
+            rowBottom.push_back(bottom);
+            rowTop.push_back(top);
+            fieldBottom = fminf(fieldBottom, bottom);
+        }
+    }
+    rowFirst.push_back((int) brickX.size());
+
+    alive.assign(brickX.size() * groups, 0);
+    hits.assign(brickX.size() * padded, 0);
+
+    lives.assign(count, 0);
+    score.assign(count, 0);
+    bricksLeft.assign(count, 0);
+    ticks.assign(count, 0);
+    tickHits.assign(count, 0);
+    finished.assign(count, PAUSE_NONE);
+
+    for (int lane = 0; lane < count; ++lane) {
+        resetLane(lane);
+    }
+}
+
+void WorldBatch::resetLane(int lane) {
+    paddleX[lane] = (float) config.screenWidth / 2.0f;
+    paddleVX[lane] = 0;
+    // World::startUp places the ball in the middle of the screen, a serve on the first tick starts from there
+    ballX[lane] = (float) config.screenWidth / 2.0f;
+    ballY[lane] = (float) config.screenHeight / 2.0f;
+    ballVX[lane] = 0;
+    ballVY[lane] = 0;
+    captured[lane] = 1;
+    left[lane] = 0;
+    right[lane] = 0;
+    shoot[lane] = 0;
+    running[lane] = 1;
+
+    lives[lane] = config.lives;
+    score[lane] = 0;
+    bricksLeft[lane] = (int) brickX.size();
+    ticks[lane] = 0;
+    tickHits[lane] = 0;
+    finished[lane] = PAUSE_NONE;
+
+    int groups = padded / Lanes::WIDTH;
+    int group = lane / Lanes::WIDTH;
+    uint32_t bit = 1u << (lane % Lanes::WIDTH);
+    for (size_t b = 0; b < brickX.size(); ++b) {
+        hits[b * padded + lane] = brickHits[b];
+        alive[b * groups + group] |= bit;
+    }
+}
+
+void WorldBatch::setInput(int lane, const WorldInput &in) {
+    left[lane] = in.left ? 1.0f : 0.0f;
+    right[lane] = in.right ? 1.0f : 0.0f;
+    shoot[lane] = in.shoot ? 1.0f : 0.0f;
+}
+
+void WorldBatch::step() {
+    int groups = padded / Lanes::WIDTH;
+    for (int g = 0; g < groups; ++g) {
+        stepGroup(g);
+    }
+}
+
+void WorldBatch::stepGroup(int group) {
+    const int base = group * Lanes::WIDTH;
+    const int groups = padded / Lanes::WIDTH;
+
+    const Lanes zero = SplatLanes(0);
+    LaneMask run = LoadLanes(running + base) > zero;
+    uint32_t runBits = MaskBits(run);
+    if (runBits == 0) {
+        return;
+    }
+
+    // fraction of a base tick covered by one tick
+    float dt = (float) config.baseTickRate / (float) config.tickRate;
+    const Lanes dtL = SplatLanes(dt);
+    const Lanes maxSpeed = SplatLanes(config.maxSpeed);
+    const Lanes radius = SplatLanes(ballRadius);
+    const Lanes push = SplatLanes(ballRadius * 1.1f);
+
+    const Lanes oldBallX = LoadLanes(ballX + base);
+    const Lanes oldBallY = LoadLanes(ballY + base);
+    const Lanes oldBallVX = LoadLanes(ballVX + base);
+    const Lanes oldBallVY = LoadLanes(ballVY + base);
+    const Lanes oldPaddleX = LoadLanes(paddleX + base);
+    const Lanes oldPaddleVX = LoadLanes(paddleVX + base);
+    const Lanes oldCaptured = LoadLanes(captured + base);
+
+    Lanes bx = oldBallX;
+    Lanes by = oldBallY;
+    Lanes bvx = oldBallVX;
+    Lanes bvy = oldBallVY;
+    Lanes px = oldPaddleX;
+    Lanes pvx = oldPaddleVX;
+
+    // input
+    Lanes speed = SplatLanes(config.paddleSpeed * dt);
+    pvx = pvx - LoadLanes(left + base) * speed;
+    pvx = pvx + LoadLanes(right + base) * speed;
+
+    LaneMask cap = oldCaptured > zero;
+    LaneMask shot = (LoadLanes(shoot + base) > zero) & cap;
+    bvx = Select(shot, SplatLanes(shootVector.x) + pvx, bvx);
+    bvy = Select(shot, SplatLanes(shootVector.y), bvy);
+    cap = cap & ~shot;
+
+    // lost balls go back onto the paddle
+    LaneMask lost = (by < SplatLanes(paddleY - paddleHeight / 2)) & run;
+    uint32_t lostBits = MaskBits(lost);
+    cap = cap | lost;
+
+    bx = Select(cap, px, bx);
+    by = Select(cap, SplatLanes(paddleY + 10), by);
+    bvx = Select(cap, zero, bvx);
+    bvy = Select(cap, zero, bvy);
+
+    // paddle, only moves along x so the speed clamp is a clamp of vx
+    float drag = (dt == 1.0f) ? paddleDrag : powf(paddleDrag, dt);
+    pvx = pvx * SplatLanes(drag);
+    pvx = Min(Max(pvx, zero - maxSpeed), maxSpeed);
+
+    const Lanes screenW = SplatLanes((float) config.screenWidth);
+    const Lanes extent = SplatLanes(paddleWidth / 2.0f);
+    px = px + pvx * dtL;
+    LaneMask hitRight = px + extent > screenW;
+    px = Select(hitRight, screenW - extent, px);
+    LaneMask hitLeft = px - extent < zero;
+    px = Select(hitLeft, extent, px);
+    pvx = Select(hitRight | hitLeft, zero, pvx);
+
+    // ball speed clamp, the ball has no drag
+    Lanes mag = Magnitude(bvx, bvy);
+    LaneMask fast = mag > maxSpeed;
+    Lanes nvx = bvx;
+    Lanes nvy = bvy;
+    Normalize(nvx, nvy);
+    bvx = Select(fast, nvx * maxSpeed, bvx);
+    bvy = Select(fast, nvy * maxSpeed, bvy);
+
+    LaneMask moving = run & ~cap;
+    uint32_t hitCount[Lanes::WIDTH] = {};
+
+    // the ball is swept like World::sweep: the closest contact of the paddle, the bricks on the path and the walls
+    // is resolved and the rest of the movement continues from there, up to maxBounces contacts per tick
+    const Lanes one = SplatLanes(1);
+    const Lanes two = SplatLanes(2);
+    const Lanes skin = SplatLanes(SKIN);
+    const Lanes minX = radius;
+    const Lanes maxX = screenW - radius;
+    const Lanes minY = radius;
+    const Lanes maxY = SplatLanes((float) config.screenHeight) - radius;
+    const Lanes halfW = extent;
+    const Lanes halfH = SplatLanes(paddleHeight / 2.0f);
+    const Lanes py = SplatLanes(paddleY);
+    const Lanes paddleDelta = px - oldPaddleX;
+    const Lanes paddleSpeedAbs = Max(pvx, zero - pvx);
+
+    Lanes remaining = one;
+    LaneMask going = moving;
+    for (int n = 0; n < config.maxBounces && MaskBits(going) != 0; ++n) {
+        Lanes deltaX = bvx * (dtL * remaining);
+        Lanes deltaY = bvy * (dtL * remaining);
+
+        LaneHit best;
+        best.t = one;
+        best.normalX = zero;
+        best.normalY = zero;
+        best.pointX = zero;
+        best.pointY = zero;
+        LaneMask onPaddle = MaskFromBits(0);
+        LaneMask onBrick = MaskFromBits(0);
+        LaneMask onWall = MaskFromBits(0);
+        int bestBrick[Lanes::WIDTH];
+
+        // the moving paddle is swept with the relative movement
+        {
+            LaneHit h;
+            Lanes rectStartX = oldPaddleX + paddleDelta * (one - remaining);
+            LaneMask take = sweepCircleRect(bx, by, deltaX - paddleDelta * remaining, deltaY, radius,
+                                            rectStartX, py, halfW, halfH, going, h);
+            take = take & (h.t < best.t);
+            takeHit(take, h, best);
+            onPaddle = take;
+        }
+
+        // bricks of the rows the paths overlap, between the leftmost and rightmost path
+        Lanes endX = bx + deltaX;
+        Lanes endY = by + deltaY;
+        Lanes pathBottom = Min(by, endY) - radius;
+        Lanes pathTop = Max(by, endY) + radius;
+        uint32_t reachBits = MaskBits(~(pathTop < SplatLanes(fieldBottom)) & going);
+        if (reachBits != 0) {
+            alignas(LANES_ALIGNMENT) float pathLeft[Lanes::WIDTH];
+            alignas(LANES_ALIGNMENT) float pathRight[Lanes::WIDTH];
+            StoreLanes(pathLeft, Min(bx, endX) - radius);
+            StoreLanes(pathRight, Max(bx, endX) + radius);
+
+            for (size_t row = 0; row + 1 < rowFirst.size(); ++row) {
+                uint32_t rowBits = reachBits & MaskBits(~(pathTop < SplatLanes(rowBottom[row]))
+                                                        & ~(pathBottom > SplatLanes(rowTop[row])));
+                if (rowBits == 0) {
+                    continue;
+                }
+
+                float lo = (float) config.screenWidth;
+                float hi = 0;
+                for (int i = 0; i < Lanes::WIDTH; ++i) {
+                    if ((rowBits >> i) & 1u) {
+                        lo = fminf(lo, pathLeft[i]);
+                        hi = fmaxf(hi, pathRight[i]);
+                    }
+                }
+
+                for (int b = rowFirst[row]; b < rowFirst[row + 1]; ++b) {
+                    if (brickX[b] + brickHalfW[b] < lo) {
+                        continue;
+                    }
+                    if (brickX[b] - brickHalfW[b] > hi) {
+                        break;
+                    }
+
+                    uint32_t candidates = alive[b * groups + group] & rowBits;
+                    if (candidates == 0) {
+                        continue;
+                    }
+
+                    LaneHit h;
+                    LaneMask take = sweepCircleRect(bx, by, deltaX, deltaY, radius,
+                                                    SplatLanes(brickX[b]), SplatLanes(brickY[b]),
+                                                    SplatLanes(brickHalfW[b]), SplatLanes(brickHalfH[b]),
+                                                    MaskFromBits(candidates), h);
+                    take = take & (h.t < best.t);
+                    uint32_t takeBits = MaskBits(take);
+                    if (takeBits == 0) {
+                        continue;
+                    }
+
+                    takeHit(take, h, best);
+                    onPaddle = onPaddle & ~take;
+                    onBrick = onBrick | take;
+                    for (int i = 0; i < Lanes::WIDTH; ++i) {
+                        if ((takeBits >> i) & 1u) {
+                            bestBrick[i] = b;
+                        }
+                    }
+                }
+            }
+        }
+
+        // walls, only when moving towards them
+        {
+            const Lanes wallT[4] = {Select(deltaX > zero, (maxX - bx) / deltaX, two),
+                                    Select(deltaX < zero, (minX - bx) / deltaX, two),
+                                    Select(deltaY > zero, (maxY - by) / deltaY, two),
+                                    Select(deltaY < zero, (minY - by) / deltaY, two)};
+            const float wallNormal[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+            for (int w = 0; w < 4; ++w) {
+                Lanes t = Max(wallT[w], zero);
+                LaneMask take = ~(t > one) & (t < best.t) & going;
+                best.t = Select(take, t, best.t);
+                best.normalX = Select(take, SplatLanes(wallNormal[w][0]), best.normalX);
+                best.normalY = Select(take, SplatLanes(wallNormal[w][1]), best.normalY);
+                onPaddle = onPaddle & ~take;
+                onBrick = onBrick & ~take;
+                onWall = onWall | take;
+            }
+        }
+
+        // lanes without a contact finish the movement
+        LaneMask contact = onPaddle | onBrick | onWall;
+        LaneMask free = going & ~contact;
+        bx = Select(free, endX, bx);
+        by = Select(free, endY, by);
+
+        bx = Select(contact, bx + deltaX * best.t + best.normalX * skin, bx);
+        by = Select(contact, by + deltaY * best.t + best.normalY * skin, by);
+        remaining = Select(contact, remaining * (one - best.t), remaining);
+
+        Lanes projX, projY;
+        Project(bvx, bvy, best.normalX, best.normalY, projX, projY);
+        bvx = Select(onWall, bvx - projX * two, bvx);
+        bvy = Select(onWall, bvy - projY * two, bvy);
+
+        // World::bounce, overlapping shapes are pushed apart, swept contacts are already touching
+        LaneMask rect = onPaddle | onBrick;
+        LaneMask pushOut = rect & ~(best.t != zero);
+        bx = Select(pushOut, best.pointX + best.normalX * push, bx);
+        by = Select(pushOut, best.pointY + best.normalY * push, by);
+
+        // the paddle bounces with its curved normal, a paddle hit from behind pushes the ball along
+        Lanes nx = Select(onPaddle, bx - px, best.normalX);
+        Lanes ny = Select(onPaddle, by - (py - SplatLanes(paddleHeight * 10)), best.normalY);
+        Lanes paddleNX = nx;
+        Lanes paddleNY = ny;
+        Normalize(paddleNX, paddleNY);
+        nx = Select(onPaddle, paddleNX, nx);
+        ny = Select(onPaddle, paddleNY, ny);
+
+        Project(bvx, bvy, nx, ny, projX, projY);
+        LaneMask toward = Dot(nx, ny, bvx, bvy) < zero;
+        Lanes rvx = Select(toward, bvx - projX * two, Select(onPaddle, bvx + nx * paddleSpeedAbs, bvx));
+        Lanes rvy = Select(toward, bvy - projY * two, Select(onPaddle, bvy + ny * paddleSpeedAbs, bvy));
+        rvx = Select(onPaddle, rvx + pvx * SplatLanes(0.5f), rvx);
+        bvx = Select(rect, rvx, bvx);
+        bvy = Select(rect, rvy, bvy);
+
+        uint32_t rectBits = MaskBits(rect);
+        uint32_t brickBits = MaskBits(onBrick);
+        for (int i = 0; i < Lanes::WIDTH; ++i) {
+            hitCount[i] += (rectBits >> i) & 1u;
+            if (((brickBits >> i) & 1u) == 0) {
+                continue;
+            }
+            int lane = base + i;
+            int b = bestBrick[i];
+            uint8_t &h = hits[(size_t) b * padded + lane];
+            score[lane] += h;
+            h -= 1;
+            if (h == 0) {
+                alive[b * groups + group] &= ~(1u << i);
+                bricksLeft[lane] -= 1;
+            }
+        }
+
+        going = contact & (remaining > zero);
+    }
+
+    // balls stay inside the walls, captured ones too
+    bx = Min(Max(bx, minX), maxX);
+    by = Min(Max(by, minY), maxY);
+
+    // lanes that already finished keep their state
+    StoreLanes(ballX + base, Select(run, bx, oldBallX));
+    StoreLanes(ballY + base, Select(run, by, oldBallY));
+    StoreLanes(ballVX + base, Select(run, bvx, oldBallVX));
+    StoreLanes(ballVY + base, Select(run, bvy, oldBallVY));
+    StoreLanes(paddleX + base, Select(run, px, oldPaddleX));
+    StoreLanes(paddleVX + base, Select(run, pvx, oldPaddleVX));
+    StoreLanes(captured + base, Select(run, Select(cap, SplatLanes(1), zero), oldCaptured));
+
+    for (int i = 0; i < Lanes::WIDTH; ++i) {
+        if (((runBits >> i) & 1u) == 0) {
+            continue;
+        }
+        int lane = base + i;
+
+        lives[lane] -= (int) ((lostBits >> i) & 1u);
+        tickHits[lane] = (int) hitCount[i];
+        ticks[lane] += 1;
+
+        if (bricksLeft[lane] == 0) {
+            finished[lane] = PAUSE_WIN;
+        } else if (lives[lane] == 0) {
+            finished[lane] = PAUSE_LOSE;
+        }
+        if (finished[lane] != PAUSE_NONE) {
+            running[lane] = 0;
+        }
+    }
+}
@@ -3,11 +3,17 @@
 //
 
 #include <Game.h>
+#include <cstdlib>
+#include <string>
 
 /*!
  * Main entry point
  *
  * Initializes A Game object and starts off the main loop.
+ * --record file saves the played ticks as a replay, --replay file plays one back in the window.
+ * --hash-log file writes the state hash of every tick, --hash-ref file compares them against such a log.
+ * --autopilot lets the trajectory predicting Autopilot play.
+ * --balls N splits N extra balls off the ball on every serve, the load test mode.
  * @param argc
  * @param args
  * @return
@@ -15,6 +21,24 @@
 int main(int argc, char* args[])
 {
     Game g;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = args[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--record" && hasValue) {
+            g.recordPath = args[++i];
+        } else if (arg == "--replay" && hasValue) {
+            g.replayPath = args[++i];
+        } else if (arg == "--hash-log" && hasValue) {
+            g.hashLog.record(args[++i]);
+        } else if (arg == "--hash-ref" && hasValue) {
+            g.hashLog.compare(args[++i]);
+        } else if (arg == "--balls" && hasValue) {
+            g.multiBall = atoi(args[++i]);
+        } else if (arg == "--autopilot") {
+            g.autopilot = true;
+        }
+    }
+
     if (g.init()) {
         g.run();
     }
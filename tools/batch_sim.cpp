@@ -0,0 +1,401 @@
+//
+// Created by jibbo on 3/28/21.
+//
+
+#include <World.h>
+#include <WorldBatch.h>
+#include <LevelFile.h>
+#include <Replay.h>
+#include <Trajectory.h>
+#include <ThreadPool.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+/*!
+ * \brief Batch run settings.
+ */
+struct BatchOptions {
+    std::vector<std::string> levels;    /**<  level files, each one is played games times */
+    int games = 1000;                   /**<  games per level */
+    int threads = 0;                    /**<  worker threads, 0 for one per hardware thread */
+    int maxTicks = 60 * 60 * 10;        /**<  ticks before a game counts as timed out */
+    int tickRate = 60;                  /**<  simulation ticks per second */
+    int multiBall = 0;                  /**<  extra balls split off the ball on every serve */
+    unsigned int seed = 1;              /**<  base seed, game i uses seed + i */
+    bool random = false;                /**<  random paddle instead of the ball tracking paddle */
+    bool autopilot = false;             /**<  trajectory predicting Autopilot instead of the ball tracking paddle */
+    bool lanes = false;                 /**<  play the games in the SIMD lanes of WorldBatch instead of one World each */
+    std::string record;                 /**<  replay file for the first game of the first level, empty for none */
+};
+
+/*!
+ * Games in one WorldBatch, each thread steps whole batches.
+ */
+static const int BATCH_GAMES = 256;
+
+/*!
+ * \brief Outcome of a single game.
+ */
+struct GameResult {
+    bool cleared = false;   /**<  every brick was broken before running out of lives */
+    bool timedOut = false;  /**<  neither cleared nor lost within maxTicks */
+    int ticks = 0;          /**<  ticks played */
+    int score = 0;          /**<  score when the game ended */
+    int livesLost = 0;      /**<  balls lost */
+};
+
+/*!
+ * \brief Pick the input of the next tick.
+ *
+ * The tracking policy follows the ball with a random aim offset picked for every serve, so the games
+ * don't all bounce the same way. The random policy holds a random direction for a random number of ticks.
+ */
+struct Policy {
+    std::mt19937 rng;           /**<  per game generator */
+    bool random = false;        /**<  policy kind */
+    float aim = 0;              /**<  tracking: offset from the paddle center the ball is kept at */
+    int hold = 0;               /**<  random: ticks left on the current direction */
+    WorldInput current;         /**<  random: held direction */
+
+    /*!
+     * \brief Input for the game state.
+     * @param ballCaptured is the ball on the paddle
+     * @param ballX ball center x
+     * @param paddleX paddle center x
+     * @param paddleWidth paddle width
+     */
+    WorldInput next(bool ballCaptured, float ballX, float paddleX, float paddleWidth) {
+        WorldInput in;
+        in.shoot = ballCaptured;
+
+        if (random) {
+            if (hold <= 0) {
+                int dir = (int) (rng() % 3);
+                current.left = dir == 0;
+                current.right = dir == 1;
+                hold = 5 + (int) (rng() % 30);
+            }
+            --hold;
+            in.left = current.left;
+            in.right = current.right;
+            return in;
+        }
+
+        if (ballCaptured) {
+            std::uniform_real_distribution<float> offset(-0.4f, 0.4f);
+            aim = offset(rng) * paddleWidth;
+        }
+
+        float target = ballX - aim;
+        in.left = target < paddleX - 5;
+        in.right = target > paddleX + 5;
+        return in;
+    }
+
+    WorldInput next(const World &world) {
+        return next(world.ballCaptured, world.entities.pos[world.ball.id].x, world.entities.pos[world.player.id].x,
+                    world.entities.width[world.player.id]);
+    }
+};
+
+/*!
+ * \brief Play one game of a level to the end.
+ * @param level level shared by every game
+ * @param options batch settings
+ * @param seed policy seed
+ * @param recording receives the inputs of the game, nullptr to not record
+ */
+static GameResult playGame(const LevelLayout &level, const BatchOptions &options, unsigned int seed,
+                           Replay *recording = nullptr) {
+    World world;
+    world.config.tickRate = options.tickRate;
+    world.config.multiBall = options.multiBall;
+    world.levels.push_back(level);
+    world.startUp();
+    world.loadLevelLayout(level);
+
+    Policy policy;
+    policy.rng.seed(seed);
+    policy.random = options.random;
+    Autopilot autopilot(seed);
+
+    if (recording != nullptr) {
+        recording->begin(world, seed);
+    }
+
+    GameResult result;
+    int lives = world.playerLives;
+    while (result.ticks < options.maxTicks) {
+        int score = world.score;
+        WorldInput in = options.autopilot ? autopilot.next(world) : policy.next(world);
+        world.step(in);
+        if (recording != nullptr) {
+            recording->record(in, world);
+        }
+        ++result.ticks;
+
+        if (world.playerLives < lives) {
+            result.livesLost += lives - world.playerLives;
+        }
+        lives = world.playerLives;
+
+        if (world.events.levelChanged) {
+            result.cleared = world.pauseReason == PAUSE_WIN;
+            // losing resets the score, keep the one the game ended with
+            result.score = result.cleared ? world.score : score;
+            if (!result.cleared) {
+                result.livesLost = world.config.lives;
+            }
+            return result;
+        }
+    }
+
+    result.timedOut = true;
+    result.score = world.score;
+    return result;
+}
+
+/*!
+ * \brief Play a range of games of a level to the end in the lanes of one WorldBatch.
+ * @param level level shared by every game
+ * @param options batch settings
+ * @param first index of the first game, game i uses seed options.seed + i
+ * @param results receives the result of every game, indexed by game
+ */
+static void playBatch(const LevelLayout &level, const BatchOptions &options, int first,
+                      std::vector<GameResult> &results) {
+    int games = std::min(BATCH_GAMES, options.games - first);
+
+    WorldBatch batch;
+    batch.config.tickRate = options.tickRate;
+    batch.startUp(games, level);
+
+    std::vector<Policy> policies(games);
+    for (int i = 0; i < games; ++i) {
+        policies[i].rng.seed(options.seed + (unsigned int) (first + i));
+        policies[i].random = options.random;
+    }
+
+    int playing = games;
+    for (int tick = 0; tick < options.maxTicks && playing > 0; ++tick) {
+        for (int i = 0; i < games; ++i) {
+            if (batch.finished[i] == PAUSE_NONE) {
+                batch.setInput(i, policies[i].next(batch.captured[i] > 0, batch.ballX[i], batch.paddleX[i],
+                                                   batch.paddleWidth));
+            }
+        }
+
+        batch.step();
+
+        for (int i = 0; i < games; ++i) {
+            GameResult &result = results[first + i];
+            if (batch.finished[i] == PAUSE_NONE || result.ticks > 0) {
+                continue;
+            }
+            result.cleared = batch.finished[i] == PAUSE_WIN;
+            result.ticks = batch.ticks[i];
+            result.score = batch.score[i];
+            result.livesLost = batch.config.lives - batch.lives[i];
+            --playing;
+        }
+    }
+
+    for (int i = 0; i < games; ++i) {
+        GameResult &result = results[first + i];
+        if (batch.finished[i] == PAUSE_NONE) {
+            result.timedOut = true;
+            result.ticks = batch.ticks[i];
+            result.score = batch.score[i];
+            result.livesLost = batch.config.lives - batch.lives[i];
+        }
+    }
+}
+
+/*!
+ * \brief Value at a fraction of a sorted list.
+ */
+template<typename T>
+static T percentile(const std::vector<T> &sorted, double p) {
+    if (sorted.empty()) {
+        return T();
+    }
+    size_t idx = (size_t) std::lround(p * (double) (sorted.size() - 1));
+    return sorted[idx];
+}
+
+/*!
+ * \brief Print the aggregate statistics of a level.
+ */
+static void report(const std::string &path, const std::vector<GameResult> &results, int threads, double seconds,
+                   const BatchOptions &options) {
+    std::vector<int> clearTicks;
+    std::vector<int> scores;
+    std::vector<int> livesLost;
+    long long ticks = 0;
+    int timedOut = 0;
+    double lostSum = 0;
+
+    for (const GameResult &r : results) {
+        if (r.cleared) {
+            clearTicks.push_back(r.ticks);
+        }
+        scores.push_back(r.score);
+        timedOut += r.timedOut;
+        ticks += r.ticks;
+        lostSum += r.livesLost;
+        if (r.livesLost >= (int) livesLost.size()) {
+            livesLost.resize(r.livesLost + 1, 0);
+        }
+        ++livesLost[r.livesLost];
+    }
+    std::sort(clearTicks.begin(), clearTicks.end());
+    std::sort(scores.begin(), scores.end());
+
+    double games = (double) results.size();
+    double scoreSum = 0;
+    for (int s : scores) {
+        scoreSum += s;
+    }
+    double clearSum = 0;
+    for (int t : clearTicks) {
+        clearSum += t;
+    }
+
+    printf("%s: %zu games, %s paddle, %d threads, %s, %.2f s (%.0f games/s, %.2fM ticks/s)\n",
+           path.c_str(), results.size(), options.autopilot ? "autopilot" : options.random ? "random" : "tracking", threads,
+           options.lanes ? LanesKernel() : "scalar worlds", seconds,
+           games / seconds, (double) ticks / seconds / 1e6);
+    printf("  %-16s %.1f%% (%d timed out after %d ticks)\n", "clear rate",
+           100.0 * (double) clearTicks.size() / games, timedOut, options.maxTicks);
+    if (!clearTicks.empty()) {
+        printf("  %-16s mean %.0f  p10 %d  p50 %d  p90 %d  max %d\n", "ticks to clear",
+               clearSum / (double) clearTicks.size(), percentile(clearTicks, 0.1), percentile(clearTicks, 0.5),
+               percentile(clearTicks, 0.9), clearTicks.back());
+    }
+    printf("  %-16s mean %.1f  min %d  p10 %d  p50 %d  p90 %d  max %d\n", "score",
+           scoreSum / games, scores.front(), percentile(scores, 0.1), percentile(scores, 0.5),
+           percentile(scores, 0.9), scores.back());
+    printf("  %-16s mean %.2f ", "lives lost", lostSum / games);
+    for (size_t i = 0; i < livesLost.size(); ++i) {
+        printf(" %zu: %.1f%%", i, 100.0 * livesLost[i] / games);
+    }
+    printf("\n");
+}
+
+/*!
+ * Batch simulator entry point
+ *
+ * Plays every level many times with a scripted or random paddle on all cores and prints
+ * clear rate, ticks to clear, score distribution and lives lost.
+ * Every game has its own World and seed, results don't depend on the thread count.
+ * The level data is loaded once and shared read only by all games.
+ * With --lanes the games run in the SIMD lanes of WorldBatch, which follows the World rules (see WorldBatch.h).
+ *
+ * --autopilot plays with the trajectory predicting Autopilot, which should clear every level without losing a life.
+ * --balls N splits N extra balls off the ball on every serve, losing them costs no life.
+ * --record saves the first game of the first level as a replay (see tools/replay.cpp).
+ *
+ * usage: batch_sim [--games N] [--threads N] [--max-ticks N] [--tick-rate N] [--seed N] [--random | --autopilot]
+ *                  [--balls N] [--lanes] [--record file] [level ...]
+ */
+int main(int argc, char* args[]) {
+    BatchOptions options;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = args[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--games" && hasValue) {
+            options.games = atoi(args[++i]);
+        } else if (arg == "--threads" && hasValue) {
+            options.threads = atoi(args[++i]);
+        } else if (arg == "--max-ticks" && hasValue) {
+            options.maxTicks = atoi(args[++i]);
+        } else if (arg == "--tick-rate" && hasValue) {
+            options.tickRate = atoi(args[++i]);
+        } else if (arg == "--seed" && hasValue) {
+            options.seed = (unsigned int) strtoul(args[++i], nullptr, 10);
+        } else if (arg == "--balls" && hasValue) {
+            options.multiBall = atoi(args[++i]);
+        } else if (arg == "--record" && hasValue) {
+            options.record = args[++i];
+        } else if (arg == "--random") {
+            options.random = true;
+        } else if (arg == "--autopilot") {
+            options.autopilot = true;
+        } else if (arg == "--lanes") {
+            options.lanes = true;
+        } else if (arg.compare(0, 2, "--") == 0) {
+            printf("usage: %s [--games N] [--threads N] [--max-ticks N] [--tick-rate N] [--seed N] "
+                   "[--random | --autopilot] [--balls N] [--lanes] [--record file] [level ...]\n", args[0]);
+            return 1;
+        } else {
+            options.levels.push_back(arg);
+        }
+    }
+
+    if (options.levels.empty()) {
+        options.levels = {"Assets/level1.txt", "Assets/level2.txt", "Assets/level3.txt"};
+    }
+    if (options.games <= 0 || options.tickRate <= 0) {
+        printf("games and tick rate must be positive\n");
+        return 1;
+    }
+    if (options.multiBall < 0 || (options.multiBall > 0 && options.lanes)) {
+        printf("--balls needs a count of at least 0 and plays World games, it can't be combined with --lanes\n");
+        return 1;
+    }
+    if (options.autopilot && (options.lanes || options.random)) {
+        printf("--autopilot plays World games, it can't be combined with --lanes or --random\n");
+        return 1;
+    }
+
+    LevelLibrary library;
+    for (const std::string &path : options.levels) {
+        if (!library.load(path)) {
+            return 1;
+        }
+    }
+
+    ThreadPool pool(options.threads);
+
+    for (size_t l = 0; l < options.levels.size(); ++l) {
+        const std::string &path = options.levels[l];
+        const LevelLayout &level = library.layouts()[l];
+        std::vector<GameResult> results(options.games);
+
+        auto start = std::chrono::steady_clock::now();
+        if (options.lanes) {
+            int batches = (options.games + BATCH_GAMES - 1) / BATCH_GAMES;
+            pool.parallelFor(batches, [&](int b) {
+                playBatch(level, options, b * BATCH_GAMES, results);
+            }, 1);
+        } else {
+            pool.parallelFor(options.games, [&](int i) {
+                results[i] = playGame(level, options, options.seed + (unsigned int) i);
+            });
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        report(path, results, pool.size() + 1, seconds, options);
+    }
+
+    if (!options.record.empty()) {
+        // games are deterministic, playing game 0 again gives the game of the statistics
+        Replay replay;
+        playGame(library.layouts()[0], options, options.seed, &replay);
+        if (!replay.save(options.record)) {
+            return 1;
+        }
+        printf("recorded game 0 of %s to %s (%d ticks)\n", options.levels[0].c_str(), options.record.c_str(),
+               replay.ticks());
+    }
+
+    return 0;
+}
@@ -0,0 +1,55 @@
+//
+// Created by jibbo on 3/26/21.
+//
+
+#include <World.h>
+#include <LevelFile.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <streambuf>
+#include <string>
+
+/*!
+ * Level compiler entry point
+ *
+ * Converts text levels to the compiled .bjl format. Brick rectangles are precomputed for the default
+ * WorldConfig (the window game's screen size) unless --no-rects is given.
+ *
+ * usage: level_compiler [--no-rects] <input.txt> <output.bjl> [<input.txt> <output.bjl> ...]
+ */
+int main(int argc, char* args[]) {
+    bool rects = true;
+    int first = 1;
+    if (argc > 1 && strcmp(args[1], "--no-rects") == 0) {
+        rects = false;
+        first = 2;
+    }
+
+    if (argc - first < 2 || (argc - first) % 2 != 0) {
+        printf("usage: %s [--no-rects] <input.txt> <output.bjl> [<input.txt> <output.bjl> ...]\n", args[0]);
+        return 1;
+    }
+
+    WorldConfig config;
+
+    for (int i = first; i + 1 < argc; i += 2) {
+        std::ifstream t(args[i]);
+        if (!t) {
+            printf("Could not open level: %s\n", args[i]);
+            return 1;
+        }
+        std::string str((std::istreambuf_iterator<char>(t)), std::istreambuf_iterator<char>());
+
+        LevelText text;
+        text.parse(str);
+        LevelLayout layout = text.layout();
+
+        if (!writeLevelFile(args[i + 1], layout, rects ? &config : nullptr)) {
+            return 1;
+        }
+        printf("%s -> %s: %u rows, %u bricks\n", args[i], args[i + 1], layout.rows, layout.bricks);
+    }
+
+    return 0;
+}
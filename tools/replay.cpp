@@ -0,0 +1,164 @@
+//
+// Created by jibbo on 3/31/21.
+//
+
+#include <World.h>
+#include <LevelFile.h>
+#include <Replay.h>
+#include <StateHash.h>
+#include <SoftRaster.h>
+#include <SceneDraw.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+/*!
+ * Replay entry point
+ *
+ * Plays a recording back headlessly at full speed and checks the state hash of every tick.
+ * Levels default to the ones the game plays (compiled levels when they exist), recordings made by batch_sim
+ * need the level they were made on passed with --level.
+ * --repeat plays the recording several times, which makes it a repeatable World::step benchmark.
+ * --hash-log writes the per field state hashes of every tick, --hash-ref compares them against such a log
+ * and names the fields of the first tick that differs.
+ * --frames writes every --frame-every-th tick as an image drawn by the software rasterizer, prefix000123.ppm,
+ * --frame-size sets the image size and --gray draws grayscale .pgm images. Needs no window or GPU.
+ *
+ * usage: replay [--level path ...] [--repeat N] [--hash-log file | --hash-ref file]
+ *               [--frames prefix [--frame-every N] [--frame-size WxH] [--gray]] file
+ */
+int main(int argc, char* args[]) {
+    std::vector<std::string> levels;
+    std::string path;
+    std::string hashLogPath;
+    std::string hashRefPath;
+    std::string framePrefix;
+    int frameEvery = 60;
+    int frameWidth = 270;
+    int frameHeight = 180;
+    int frameChannels = 4;
+    int repeat = 1;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = args[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--level" && hasValue) {
+            levels.emplace_back(args[++i]);
+        } else if (arg == "--repeat" && hasValue) {
+            repeat = atoi(args[++i]);
+        } else if (arg == "--hash-log" && hasValue) {
+            hashLogPath = args[++i];
+        } else if (arg == "--hash-ref" && hasValue) {
+            hashRefPath = args[++i];
+        } else if (arg == "--frames" && hasValue) {
+            framePrefix = args[++i];
+        } else if (arg == "--frame-every" && hasValue) {
+            frameEvery = atoi(args[++i]);
+        } else if (arg == "--frame-size" && hasValue) {
+            if (sscanf(args[++i], "%dx%d", &frameWidth, &frameHeight) != 2) {
+                frameWidth = 0;
+            }
+        } else if (arg == "--gray") {
+            frameChannels = 1;
+        } else if (arg.compare(0, 2, "--") == 0 || !path.empty()) {
+            path.clear();
+            break;
+        } else {
+            path = arg;
+        }
+    }
+
+    if (path.empty() || repeat <= 0 || frameEvery <= 0 || frameWidth <= 0 || frameHeight <= 0) {
+        printf("usage: %s [--level path ...] [--repeat N] [--hash-log file | --hash-ref file]\n"
+               "       [--frames prefix [--frame-every N] [--frame-size WxH] [--gray]] file\n", args[0]);
+        return 1;
+    }
+
+    Replay replay;
+    if (!replay.load(path)) {
+        return 1;
+    }
+
+    LevelLibrary library;
+    for (const std::string &level : levels) {
+        if (!library.load(level)) {
+            return 1;
+        }
+    }
+    // the bundled levels like the game loads them
+    if (levels.empty()) {
+        for (const char *level : {"level1", "level2", "level3"}) {
+            if (!library.loadNewest(std::string(BREAKJOE_COMPILED_LEVEL_DIR "/") + level + ".bjl",
+                                    std::string("Assets/") + level + ".txt")) {
+                return 1;
+            }
+        }
+    }
+
+    double seconds = 0;
+    for (int r = 0; r < repeat; ++r) {
+        World world;
+        world.levels = library.layouts();
+        if (!replay.setUp(world)) {
+            return 1;
+        }
+
+        // every repetition checks against the reference, the log is written once
+        StateHashLog hashLog;
+        if (!hashRefPath.empty() && !hashLog.compare(hashRefPath)) {
+            return 1;
+        }
+        if (!hashLogPath.empty() && r == 0 && !hashLog.record(hashLogPath)) {
+            return 1;
+        }
+
+        // frames are only written by the first repetition
+        SoftRaster raster;
+        bool capture = !framePrefix.empty() && r == 0;
+        if (capture && !raster.init(frameWidth, frameHeight, frameChannels, world.config.screenWidth,
+                                    world.config.screenHeight)) {
+            return 1;
+        }
+        int frames = 0;
+
+        auto start = std::chrono::steady_clock::now();
+        for (int tick = 0; tick < replay.ticks(); ++tick) {
+            world.step(replay.input(tick));
+            if (!hashLog.tickDone(world)) {
+                return 2;
+            }
+            if (!replay.check(tick, world)) {
+                printf("%s: diverged at tick %d of %d\n", path.c_str(), tick, replay.ticks());
+                return 2;
+            }
+
+            if (capture && tick % frameEvery == 0) {
+                raster.clear(0, 0, 0);
+                drawWorldEntities(raster, world, 1.0f);
+
+                char name[16];
+                snprintf(name, sizeof(name), "%06d", tick);
+                if (!raster.save(framePrefix + name + (frameChannels == 1 ? ".pgm" : ".ppm"))) {
+                    return 1;
+                }
+                ++frames;
+            }
+        }
+        if (capture) {
+            printf("%s: wrote %d frames to %s*\n", path.c_str(), frames, framePrefix.c_str());
+        }
+        seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        if (r == repeat - 1) {
+            printf("%s: %d ticks match, seed %u, level %d, score %d, lives %d, %s\n", path.c_str(), replay.ticks(),
+                   replay.header.seed, world.levelId + 1, world.score, world.playerLives,
+                   replay.hashes.empty() ? "no hashes recorded" : "hashes checked");
+        }
+    }
+
+    double ticks = (double) replay.ticks() * repeat;
+    printf("  %.0f ticks in %.3f s (%.2fM ticks/s)\n", ticks, seconds, ticks / seconds / 1e6);
+    return 0;
+}